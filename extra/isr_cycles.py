@@ -0,0 +1,388 @@
+#!/usr/bin/env python3
+"""
+isr_cycles.py - Static cycle counts for the interrupt handlers in a Grbl build
+
+Reads the linked firmware ELF (e.g. .pio/build/uno/firmware.elf), decodes the AVR code of each
+handler and everything it calls, and prints the shortest and longest path through it in CPU
+cycles, including the interrupt response and the vector table jump:
+
+    isr_cycles.py firmware.elf [function ...]
+
+With no function names, every __vector_N handler in the image is reported. Cycle counts are for
+the ATmega328P (16-bit PC). Counted loops are bounded automatically when they follow the usual
+compiler patterns ('ldi'..'dec'/'brne' or an '_delay_us()' 'sbiw'/'brne' loop). Any other loop
+needs a bound from the command line, given as the loop head's byte address:
+
+    isr_cycles.py firmware.elf --loop 0x1a2c=8 __vector_11
+
+A function that can't be counted, or a path that shouldn't be, can be given a fixed cost. The
+alarm path through mc_reset() ends in the st_go_idle() lock time delay, so leave it out with:
+
+    isr_cycles.py firmware.elf --cost mc_reset=0
+
+The counts are for the code paths only. They don't know which paths are taken at run time, how
+long a nested interrupt holds the handler off, or anything about cycles stolen by other handlers.
+"""
+
+import argparse
+import struct
+import sys
+import threading
+
+VECTOR_OVERHEAD = 4 + 3  # Interrupt response, then the 'jmp' in the vector table.
+
+
+class Insn:
+    def __init__(self, addr, size, kind, cycles, target=None, reg=None, value=None, name=''):
+        self.addr = addr
+        self.size = size
+        self.kind = kind      # 'op', 'branch', 'skip', 'jump', 'call', 'ret', 'indirect'
+        self.cycles = cycles  # Cycles when not branching or skipping.
+        self.target = target
+        self.reg = reg        # Destination register of 'ldi', 'dec' and 'sbiw'.
+        self.value = value    # Immediate of 'ldi' and 'sbiw'.
+        self.name = name
+
+
+def signed(value, bits):
+    return value - (1 << bits) if value & (1 << (bits - 1)) else value
+
+
+def decode(code, addr):
+    w = code[addr] | (code[addr + 1] << 8)
+    nxt = addr + 2
+
+    def word2():
+        return code[addr + 2] | (code[addr + 3] << 8)
+
+    if w & 0xFC00 == 0x1000:  # cpse
+        return Insn(addr, 2, 'skip', 1)
+    if w & 0xD000 == 0x8000:  # ld/st with Y or Z and displacement
+        return Insn(addr, 2, 'op', 2)
+    if w & 0xFE0F == 0x9000 or w & 0xFE0F == 0x9200:  # lds, sts
+        return Insn(addr, 4, 'op', 2)
+    if w & 0xFC00 == 0x9000 or w & 0xFC00 == 0x9200:
+        if w & 0xFE0E == 0x9004 or w & 0xFE0E == 0x9006:  # lpm, elpm Z
+            return Insn(addr, 2, 'op', 3)
+        return Insn(addr, 2, 'op', 2)  # ld, st, push, pop
+    if w & 0xFE0E == 0x940C:  # jmp
+        return Insn(addr, 4, 'jump', 3, target=(((w & 0x01F0) >> 3 | (w & 1)) << 16 | word2()) * 2)
+    if w & 0xFE0E == 0x940E:  # call
+        return Insn(addr, 4, 'call', 4, target=(((w & 0x01F0) >> 3 | (w & 1)) << 16 | word2()) * 2)
+    if w in (0x9508, 0x9518):  # ret, reti
+        return Insn(addr, 2, 'ret', 4)
+    if w in (0x9409, 0x9419, 0x9509, 0x9519):  # ijmp, eijmp, icall, eicall
+        return Insn(addr, 2, 'indirect', 3)
+    if w in (0x95C8, 0x95D8):  # lpm, elpm
+        return Insn(addr, 2, 'op', 3)
+    if w & 0xFE0F == 0x940A:  # dec
+        return Insn(addr, 2, 'op', 1, reg=(w >> 4) & 0x1F, name='dec')
+    if w & 0xFF00 == 0x9600:  # adiw
+        return Insn(addr, 2, 'op', 2)
+    if w & 0xFF00 == 0x9700:  # sbiw
+        return Insn(addr, 2, 'op', 2, reg=24 + ((w >> 4) & 3) * 2,
+                    value=((w >> 2) & 0x30) | (w & 0x0F), name='sbiw')
+    if w & 0xFD00 == 0x9800:  # cbi, sbi
+        return Insn(addr, 2, 'op', 2)
+    if w & 0xFD00 == 0x9900:  # sbic, sbis
+        return Insn(addr, 2, 'skip', 1)
+    if w & 0xFC00 == 0x9C00 or w & 0xFF00 == 0x0200 or w & 0xFF00 == 0x0300:  # mul, muls, mulsu, fmul
+        return Insn(addr, 2, 'op', 2)
+    if w & 0xE000 == 0xC000:  # rjmp, rcall
+        target = nxt + signed(w & 0x0FFF, 12) * 2
+        if w & 0x1000:
+            return Insn(addr, 2, 'call', 3, target=target)
+        return Insn(addr, 2, 'jump', 2, target=target)
+    if w & 0xF000 == 0xE000:  # ldi
+        return Insn(addr, 2, 'op', 1, reg=16 + ((w >> 4) & 0x0F),
+                    value=((w >> 4) & 0xF0) | (w & 0x0F), name='ldi')
+    if w & 0xF800 == 0xF000:  # brbs, brbc
+        return Insn(addr, 2, 'branch', 1, target=nxt + signed((w >> 3) & 0x7F, 7) * 2)
+    if w & 0xFC08 == 0xFC00:  # sbrc, sbrs
+        return Insn(addr, 2, 'skip', 1)
+    return Insn(addr, 2, 'op', 1)
+
+
+class Image:
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            elf = f.read()
+        if elf[:4] != b'\x7fELF' or elf[4] != 1:
+            sys.exit('%s: not a 32-bit ELF file' % path)
+        shoff, = struct.unpack_from('<I', elf, 32)
+        shentsize, shnum, _ = struct.unpack_from('<HHH', elf, 46)
+        sections = [struct.unpack_from('<IIIIIIIIII', elf, shoff + i * shentsize) for i in range(shnum)]
+        self.code = {}
+        self.functions = {}
+        self.names = {}
+        for name, kind, flags, addr, offset, size, link, _, _, entsize in sections:
+            if kind == 1 and flags & 0x4:  # PROGBITS, executable
+                for i in range(size):
+                    self.code[addr + i] = elf[offset + i]
+            elif kind == 2:  # SYMTAB
+                strtab = sections[link][4]
+                for i in range(size // entsize):
+                    sname, value, ssize, info, _, shndx = struct.unpack_from('<IIIBBH', elf, offset + i * entsize)
+                    if info & 0x0F == 2 and shndx:  # FUNC, defined
+                        end = elf.index(b'\0', strtab + sname)
+                        label = elf[strtab + sname:end].decode()
+                        self.functions[label] = (value, ssize)
+                        self.names.setdefault(value, label)
+
+    def insn(self, addr):
+        if addr not in self.code or addr + 1 not in self.code:
+            return None
+        return decode(self.code, addr)
+
+
+class Counter:
+    def __init__(self, image, loops, costs):
+        self.image = image
+        self.loops = loops
+        self.costs = costs
+        self.cache = {}
+        self.active = set()
+
+    def name(self, addr):
+        return self.image.names.get(addr, '0x%x' % addr)
+
+    def function(self, addr):
+        name = self.name(addr)
+        if name in self.costs:
+            return self.costs[name]
+        if addr in self.cache:
+            return self.cache[addr]
+        if addr in self.active:
+            raise ValueError('%s is recursive' % name)
+        if self.image.insn(addr) is None:
+            raise ValueError('call to %s, outside the image. Give its cost with --cost' % name)
+        self.active.add(addr)
+        try:
+            self.cache[addr] = Function(self, addr).cost()
+        except ValueError as err:
+            raise ValueError('%s > %s' % (name, err) if not str(err).startswith(name + ':') else str(err))
+        finally:
+            self.active.discard(addr)
+        return self.cache[addr]
+
+
+class Function:
+    def __init__(self, counter, entry):
+        self.counter = counter
+        self.entry = entry
+        self.label = counter.name(entry)
+        size = counter.image.functions.get(self.label, (entry, 0))[1]
+        self.end = entry + size if size else None
+        self.insns = {}
+        self.edges = {}  # addr -> [(next addr or None for exit, min, max)]
+        self.walk()
+
+    def inside(self, addr):
+        return self.end is None or self.entry <= addr < self.end
+
+    def walk(self):
+        todo = [self.entry]
+        while todo:
+            addr = todo.pop()
+            if addr in self.insns:
+                continue
+            insn = self.counter.image.insn(addr)
+            if insn is None:
+                raise ValueError('%s: runs off the image at 0x%x' % (self.label, addr))
+            self.insns[addr] = insn
+            nxt = addr + insn.size
+            edges = []
+            if insn.kind == 'op':
+                edges.append((nxt, insn.cycles, insn.cycles))
+            elif insn.kind == 'branch':
+                edges += [(nxt, 1, 1), (insn.target, 2, 2)]
+            elif insn.kind == 'skip':
+                skipped = self.counter.image.insn(nxt)
+                cycles = 1 + skipped.size // 2
+                edges += [(nxt, 1, 1), (nxt + skipped.size, cycles, cycles)]
+            elif insn.kind == 'call':
+                low, high = self.counter.function(insn.target)
+                edges.append((nxt, insn.cycles + low, insn.cycles + high))
+            elif insn.kind == 'jump':
+                if self.inside(insn.target):
+                    edges.append((insn.target, insn.cycles, insn.cycles))
+                else:  # Tail call
+                    low, high = self.counter.function(insn.target)
+                    edges.append((None, insn.cycles + low, insn.cycles + high))
+            elif insn.kind == 'ret':
+                edges.append((None, insn.cycles, insn.cycles))
+            else:
+                raise ValueError('%s: indirect jump or call at 0x%x' % (self.label, addr))
+            self.edges[addr] = edges
+            todo += [e[0] for e in edges if e[0] is not None]
+
+    def succ(self, node, nodes, head):
+        # Edges within a region, leaving out the ones back to its loop head.
+        return [e for e in self.edges[node] if e[0] in nodes and e[0] != head]
+
+    def sccs(self, nodes, head):
+        # Tarjan's algorithm, iterative so long functions don't run out of stack. The components
+        # come out in reverse topological order.
+        index, low, stack, on_stack, result = {}, {}, [], set(), []
+        for root in nodes:
+            if root in index:
+                continue
+            work = [(root, 0)]
+            while work:
+                node, i = work.pop()
+                if i == 0:
+                    index[node] = low[node] = len(index)
+                    stack.append(node)
+                    on_stack.add(node)
+                succ = self.succ(node, nodes, head)
+                if i < len(succ):
+                    work.append((node, i + 1))
+                    nxt = succ[i][0]
+                    if nxt not in index:
+                        work.append((nxt, 0))
+                    elif nxt in on_stack:
+                        low[node] = min(low[node], index[nxt])
+                    continue
+                if low[node] == index[node]:
+                    scc = set()
+                    while True:
+                        member = stack.pop()
+                        on_stack.discard(member)
+                        scc.add(member)
+                        if member == node:
+                            break
+                    result.append(scc)
+                if work:
+                    parent = work[-1][0]
+                    low[parent] = min(low[parent], low[node])
+        return result
+
+    def bound(self, head, scc):
+        if head in self.counter.loops:
+            return self.counter.loops[head]
+        # Counted loop: 'dec rN' then 'brne' back, with rN loaded by an 'ldi' ahead of the loop.
+        # A delay loop is the same with 'sbiw r24,1' and a 16-bit count in r25:r24.
+        for addr in scc:
+            insn = self.insns[addr]
+            branch = self.insns.get(addr + insn.size)
+            if branch is None or branch.kind != 'branch' or branch.target not in scc:
+                continue
+            if insn.name == 'dec':
+                count = self.loaded(scc, insn.reg)
+                if count is not None:
+                    return count or 0x100
+            elif insn.name == 'sbiw' and insn.value == 1:
+                low, high = self.loaded(scc, insn.reg), self.loaded(scc, insn.reg + 1)
+                if low is not None and high is not None:
+                    return (high << 8 | low) or 0x10000
+        raise ValueError('%s: loop at 0x%x needs a bound. Give it with --loop 0x%x=N'
+                         % (self.label, head, head))
+
+    def loaded(self, scc, reg):
+        # The count comes from the nearest 'ldi' of its register just ahead of the loop.
+        start = min(scc)
+        for addr in sorted((a for a in self.insns if start - 16 <= a < start), reverse=True):
+            insn = self.insns[addr]
+            if insn.name == 'ldi' and insn.reg == reg:
+                return insn.value
+        return None
+
+    def paths(self, nodes, start, head):
+        # Shortest and longest path from start to each node of a region. A loop inside the region
+        # is entered at its head, goes round once per pass and leaves from wherever it exits.
+        preds = {}
+        for node in nodes:
+            for nxt, _, _ in self.succ(node, nodes, head):
+                preds.setdefault(nxt, set()).add(node)
+        dist = {start: (0, 0)}
+
+        def reach(node, low, high):
+            cur = dist.get(node)
+            dist[node] = (low, high) if cur is None else (min(cur[0], low), max(cur[1], high))
+
+        for scc in reversed(self.sccs(nodes, head)):
+            node = next(iter(scc))
+            if len(scc) > 1 or any(e[0] == node for e in self.succ(node, nodes, head)):
+                heads = [n for n in scc if n == start or preds.get(n, set()) - scc]
+                if len(heads) != 1:
+                    raise ValueError('%s: loop with %d entries near 0x%x' % (self.label, len(heads), min(scc)))
+                inner = self.paths(scc, heads[0], heads[0])
+                back = [(inner[n][0] + emin, inner[n][1] + emax)
+                        for n in scc if n in inner for nxt, emin, emax in self.edges[n] if nxt == heads[0]]
+                passes = self.bound(heads[0], scc)
+                if heads[0] not in dist:
+                    continue
+                low = dist[heads[0]][0] + (passes - 1) * min(b[0] for b in back)
+                high = dist[heads[0]][1] + (passes - 1) * max(b[1] for b in back)
+                for n in inner:
+                    dist[n] = (low + inner[n][0], high + inner[n][1])
+            if node not in dist:
+                continue
+            for member in scc:
+                for nxt, emin, emax in self.succ(member, nodes, head):
+                    if nxt not in scc:
+                        reach(nxt, dist[member][0] + emin, dist[member][1] + emax)
+        return dist
+
+    def cost(self):
+        dist = self.paths(set(self.insns), self.entry, None)
+        exits = [(dist[n][0] + emin, dist[n][1] + emax)
+                 for n in dist for nxt, emin, emax in self.edges[n] if nxt is None]
+        if not exits:
+            raise ValueError('%s: never returns' % self.label)
+        return min(e[0] for e in exits), max(e[1] for e in exits)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Static cycle counts for AVR interrupt handlers.')
+    parser.add_argument('elf')
+    parser.add_argument('functions', nargs='*', help='default: every __vector_N handler')
+    parser.add_argument('--loop', action='append', default=[], metavar='ADDR=N',
+                        help='passes through the loop headed at byte address ADDR')
+    parser.add_argument('--cost', action='append', default=[], metavar='NAME=MIN[:MAX]',
+                        help='cycles for a function outside the image, excluding the call')
+    parser.add_argument('--f-cpu', type=float, default=16e6)
+    args = parser.parse_intermixed_args()
+
+    image = Image(args.elf)
+    loops = {}
+    for item in args.loop:
+        addr, passes = item.split('=')
+        loops[int(addr, 0)] = int(passes, 0)
+    costs = {}
+    for item in args.cost:
+        name, cycles = item.split('=')
+        low, _, high = cycles.partition(':')
+        costs[name] = (int(low), int(high or low))
+    names = args.functions or sorted((n for n in image.functions if n.startswith('__vector_')),
+                                     key=lambda n: int(n[9:]) if n[9:].isdigit() else 0)
+
+    counter = Counter(image, loops, costs)
+    status = 0
+    for name in names:
+        if name not in image.functions:
+            sys.stderr.write('%s: no such function\n' % name)
+            status = 1
+            continue
+        try:
+            low, high = counter.function(image.functions[name][0])
+        except ValueError as err:
+            sys.stderr.write('%s\n' % err)
+            status = 1
+            continue
+        if name.startswith('__vector_'):
+            low += VECTOR_OVERHEAD
+            high += VECTOR_OVERHEAD
+        print('%-16s min %6d  max %6d cycles  (%.1f - %.1f us)'
+              % (name, low, high, low * 1e6 / args.f_cpu, high * 1e6 / args.f_cpu))
+    return status
+
+
+if __name__ == '__main__':
+    sys.setrecursionlimit(100000)
+    threading.stack_size(256 * 1024 * 1024)
+    result = []
+    worker = threading.Thread(target=lambda: result.append(main()))
+    worker.start()
+    worker.join()
+    sys.exit(result[0] if result else 1)
@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+"""
+thc_capture.py - Reconstructs an arc voltage trace from THC capture records
+
+Reads a log of realtime status reports from a controller built with ENABLE_THC_CAPTURE
+(from a file or stdin), extracts the hex-encoded "CAP" fields and prints the trace as CSV:
+
+    time_ms, adc, arc_ok, z_steps, z_total, feed
+
+time_ms is unwrapped from the 16-bit millis stamp, and z_total is the running sum of the
+THC Z corrections in steps. Dropped records ("CAP_DROP") are reported on stderr.
+
+Usage: thc_capture.py [logfile] > trace.csv
+"""
+
+import re
+import struct
+import sys
+
+RECORD = struct.Struct('<HHbH')  # time, adc, z_steps, feed. Packed, little-endian (AVR).
+ARC_OK_BIT = 15
+
+CAP_FIELD = re.compile(r'"CAP"\s*:\s*"([0-9A-Fa-f]*)"')
+DROP_FIELD = re.compile(r'"CAP_DROP"\s*:\s*(\d+)')
+
+
+def records(lines):
+    for line in lines:
+        drop = DROP_FIELD.search(line)
+        if drop:
+            sys.stderr.write('warning: %s capture records dropped\n' % drop.group(1))
+        cap = CAP_FIELD.search(line)
+        if not cap:
+            continue
+        data = bytes.fromhex(cap.group(1))
+        if len(data) % RECORD.size:
+            sys.stderr.write('warning: skipping malformed chunk: %s\n' % cap.group(1))
+            continue
+        for offset in range(0, len(data), RECORD.size):
+            yield RECORD.unpack_from(data, offset)
+
+
+def main():
+    src = open(sys.argv[1]) if len(sys.argv) > 1 else sys.stdin
+    print('time_ms,adc,arc_ok,z_steps,z_total,feed')
+    last_stamp = None
+    time_ms = 0
+    z_total = 0
+    for stamp, adc, z_steps, feed in records(src):
+        if last_stamp is not None:
+            time_ms += (stamp - last_stamp) & 0xFFFF
+        last_stamp = stamp
+        z_total += z_steps
+        arc_ok = (adc >> ARC_OK_BIT) & 1
+        print('%d,%d,%d,%d,%d,%d' % (time_ms, adc & 0x3FF, arc_ok, z_steps, z_total, feed))
+
+
+if __name__ == '__main__':
+    main()
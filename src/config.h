@@ -84,6 +84,18 @@
 #define CMD_SPINDLE_OVR_STOP 0x9E
 #define CMD_COOLANT_FLOOD_OVR_TOGGLE 0xA0
 #define CMD_COOLANT_MIST_OVR_TOGGLE 0xA1
+// The override set commands are two bytes, the command and a binary percentage (1-255). The value
+// byte is taken as the value, even when it matches a realtime character, and is clamped to the
+// MIN/MAX override limits below. The exception is CMD_RESET, which always resets and drops the set,
+// so 24% (0x18) can't be set directly. A whole override change then costs a single planner update, as
+// opposed to a burst of increments. The rapid override may be set to any percentage between low and 100%.
+#define CMD_FEED_OVR_SET 0xA2           // Sets the feed override to the percentage in the next byte.
+#define CMD_RAPID_OVR_SET 0xA3          // Sets the rapid override to the percentage in the next byte.
+#define CMD_SPINDLE_OVR_SET 0xA4        // Sets the spindle override to the percentage in the next byte.
+#define CMD_JOG_SPEED_SLOW 0x88         // Continuous jog speed select. See ENABLE_CONTINUOUS_JOG.
+#define CMD_JOG_SPEED_MEDIUM 0x89
+#define CMD_JOG_SPEED_FAST 0x8A
+#define CMD_JOG_CONTINUOUS 0xA5         // Continuous jog, direction bits in the next byte.
 
 // If homing is enabled, homing init lock sets Grbl into an alarm state upon power up. This forces
 // the user to perform the homing cycle (or override the locks) before doing anything else. This is
@@ -120,6 +132,16 @@
 // greater.
 #define N_HOMING_LOCATE_CYCLE 1 // Integer (1-128)
 
+// Homing switches are latched by the limit pin change interrupt, which locks the axis out the instant
+// its switch triggers. By default, the seek approach stops this way, abruptly. This option instead
+// decelerates a lone seeking axis to a stop past its switch, at the axis acceleration, and references
+// the latched trigger position. Allows a seek rate near the max rate. A dual axis decelerates from its
+// first switch and latches the other side during the overtravel. If that side doesn't trigger before
+// the stop, homing fails with the dual axis approach alarm. Cycles homing more than one axis and
+// CoreXY still stop abruptly.
+// NOTE: The switch must allow the overtravel, (seek rate)^2/(2*acceleration), past its trigger point.
+// #define HOMING_SEEK_DECELERATE // Default disabled. Uncomment to enable.
+
 // Enables single axis homing commands. $HX, $HY, and $HZ for X, Y, and Z-axis homing. The full homing 
 // cycle is still invoked by the $H command. This is disabled by default. It's here only to address
 // users that need to switch between a two-axis and three-axis machine. This is actually very rare.
@@ -137,6 +159,11 @@
 // parser state depending on user preferences.
 #define N_STARTUP_LINE 2 // Integer (1-2)
 
+// Number of cut parameter profiles stored in EEPROM. Each holds the axis max rates and accelerations,
+// junction deviation and the THC target, deadband and arc delay. Stored from the current settings
+// with '$PS=n' and swapped into RAM with '$P=n', without an EEPROM write. '$P' lists them.
+#define N_PROFILE 4 // Integer (1-4)
+
 // Number of floating decimal points printed by Grbl for certain value types. These settings are
 // determined by realistic and commonly observed values in CNC machines. For example, position
 // values cannot be less than 0.001mm or 0.0001in, because machines can not be physically more
@@ -226,6 +253,11 @@
 // OEMs and LinuxCNC users that would like this power-cycle behavior.
 // #define FORCE_INITIALIZATION_ALARM // Default disabled. Uncomment to enable.
 
+// The journal keeps the machine position at the end of each cut and program in EEPROM. This option
+// restores it as the machine position upon power-up, for machines without homing that are not moved
+// while powered off. A machine moved by hand is silently offset, so home or re-zero if in doubt.
+// #define JOURNAL_RESTORE_POSITION // Default disabled. Uncomment to enable.
+
 // At power-up or a reset, Grbl will check the limit switch states to ensure they are not active
 // before initialization. If it detects a problem and the hard limits setting is enabled, Grbl will
 // simply message the user to check the limits and enter an alarm state, rather than idle. Grbl will
@@ -432,7 +464,9 @@
 // available RAM, like when re-compiling for a Mega2560. Or decrease if the Arduino begins to
 // crash due to the lack of available RAM or if the CPU is having trouble keeping up with planning
 // new incoming motions as they are executed.
-// #define BLOCK_BUFFER_SIZE 16 // Uncomment to override default in planner.h.
+// NOTE: Two blocks less than the default, for the RAM taken by the THC, journal and EEPROM write queue.
+// Fourteen blocks still hold several times the stopping distance at plasma cut speeds.
+#define BLOCK_BUFFER_SIZE 14 // Comment to use the default in planner.h.
 
 // Governs the size of the intermediary step segment buffer between the step execution algorithm
 // and the planner blocks. Each segment is set of steps executed at a constant velocity over a
@@ -440,7 +474,11 @@
 // block velocity profile is traced exactly. The size of this buffer governs how much step
 // execution lead time there is for other Grbl processes have to compute and do their thing
 // before having to come back and refill this buffer, currently at ~50msec of step moves.
-// #define SEGMENT_BUFFER_SIZE 6 // Uncomment to override default in stepper.h.
+// By default, the depth is derived from a RAM budget for the segment and stepper block buffers.
+// The default budget gives 7 segments with the shipped config (dual axis and variable spindle: 7 byte
+// segment_t, 19 byte st_block_t). Underruns are counted in the status report.
+// #define SEGMENT_BUFFER_RAM_BUDGET 168 // Bytes. Uncomment to override default in stepper.h.
+// #define SEGMENT_BUFFER_SIZE 6 // Uncomment to set the depth directly. Overrides the RAM budget.
 
 // Line buffer size from the serial input stream to be executed. Also, governs the size of
 // each of the startup blocks, as they are each stored as a string of this size. Make sure
@@ -474,6 +512,34 @@
 // work well and are cheap to find) and wire in a low-pass circuit into each limit pin.
 // #define ENABLE_SOFTWARE_DEBOUNCE // Default disabled. Uncomment to enable.
 
+// Filters the hard limit inputs on the THC tick, instead of alarming on a pin change. A change is
+// only accepted after INPUT_FILTER_SAMPLES consecutive agreeing samples, so noise bursts shorter than
+// the window, like plasma HF starts, are rejected. A clean limit hit is delayed by exactly the window,
+// INPUT_FILTER_SAMPLES ticks of 128 usec (125 usec without VARIABLE_SPINDLE). A bouncing one is
+// delayed until it settles. $B reports rejected glitches and the max latency seen.
+// NOTE: Homing switches are still latched on the pin change. Not compatible with ENABLE_SOFTWARE_DEBOUNCE.
+// The control inputs are not filtered, as their pins carry the arc voltage and ARC_OK in this build.
+#define ENABLE_INPUT_FILTER // Default enabled. Comment to disable.
+#define INPUT_FILTER_SAMPLES 8 // Integer (2-255). 8 samples is ~1 msec.
+
+// Continuous jog on realtime bytes, for jog buttons and pendants. CMD_JOG_CONTINUOUS followed by a
+// direction byte starts a jog: bit 0 X+, bit 1 X-, bit 2 Y+, bit 3 Y-, bit 4 Z+, bit 5 Z-. Several axes
+// may be combined, so 0xA5 0x05 jogs X+Y+ at 45 degrees. As with the override set commands, the
+// direction byte is taken whatever its value, so the 0xC0-0xFF UTF-8 lead bytes stay unclaimed, but
+// CMD_RESET still resets, so Y-Z+ (0x18) can't be jogged. The jog is planned as a single block to the
+// end of travel, or to the soft limits if enabled, at a percentage of the slowest jogged axis max
+// rate selected by the CMD_JOG_SPEED bytes. The planner ramps it up, and CMD_JOG_CANCEL decelerates it to
+// a stop, so the stop distance is only the deceleration distance. A new direction while jogging
+// cancels the current jog and starts once stopped. Repeats of the same direction are ignored.
+// NOTE: Accepted only when idle or jogging. A speed change applies to the next jog.
+// NOTE: The latency from the direction byte to motion is unmeasured. It is the rest of the main loop
+// pass, then planning the block and filling the segment buffer before st_wake_up(). Time it on the
+// target, e.g. with a spare pin toggled around jog_continuous_execute(), before relying on it.
+#define ENABLE_CONTINUOUS_JOG // Default enabled. Comment to disable.
+#define JOG_CONTINUOUS_SPEED_SLOW 10 // Percent of max rate (1-100)
+#define JOG_CONTINUOUS_SPEED_MEDIUM 30 // Percent of max rate (1-100). Used upon power-up.
+#define JOG_CONTINUOUS_SPEED_FAST 100 // Percent of max rate (1-100)
+
 // Configures the position after a probing cycle during Grbl's check mode. Disabled sets
 // the position to the probe target, when enabled sets the position to the start position.
 // #define SET_CHECK_MODE_PROBE_TO_START // Default disabled. Uncomment to enable.
@@ -522,19 +588,14 @@
 // NOTE: See the included grblWrite_BuildInfo.ino example file to write this string seperately.
 #define ENABLE_BUILD_INFO_WRITE_COMMAND // '$I=' Default enabled. Comment to disable.
 
-// AVR processors require all interrupts to be disabled during an EEPROM write. This includes both
-// the stepper ISRs and serial comm ISRs. In the event of a long EEPROM write, this ISR pause can
-// cause active stepping to lose position and serial receive data to be lost. This configuration
-// option forces the planner buffer to completely empty whenever the EEPROM is written to prevent
-// any chance of lost steps.
-// However, this doesn't prevent issues with lost serial RX data during an EEPROM write, especially
-// if a GUI is premptively filling up the serial RX buffer simultaneously. It's highly advised for
-// GUIs to flag these gcodes (G10,G28.1,G30.1) to always wait for an 'ok' after a block containing
-// one of these commands before sending more data to eliminate this issue.
+// EEPROM writes are queued and programmed in the background by the EE_READY interrupt, so the
+// stepper, serial and THC interrupts keep running and coordinate set g-code commands (G10,G28.1,
+// G30.1) no longer need to stop motion. This option restores the old behavior of forcing the
+// planner buffer to completely empty before these commands write to EEPROM.
 // NOTE: Most EEPROM write commands are implicitly blocked during a job (all '$' commands). However,
 // coordinate set g-code commands (G10,G28/30.1) are not, since they are part of an active streaming
 // job. At this time, this option only forces a planner buffer sync with these g-code commands.
-#define FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE // Default enabled. Comment to disable.
+// #define FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE // Default disabled. Uncomment to enable.
 
 // In Grbl v0.9 and prior, there is an old outstanding bug where the `WPos:` work position reported
 // may not correlate to what is executing, because `WPos:` is based on the g-code parser state, which
@@ -678,6 +739,30 @@
 // #define DUAL_AXIS_CONFIG_CNC_SHIELD_CLONE  // Uncomment to select. Comment other configs.
 
 
+/* ---------------------------------------------------------------------------------------
+   Torch height control (THC) options. The THC runs from the Timer2 tick in main.c and
+   corrects Z from the arc voltage on A0 while ARC_OK (A1) is low.
+*/
+
+// Records arc voltage, net THC Z correction and the realtime feed rate into a small RAM ring
+// buffer while the machine is in motion. Pending records are drained in hex-encoded chunks
+// appended to the realtime status report as a "CAP" field, and decoded on the host with the
+// 'thc_capture.py' script in the /extra folder. Intended for THC and cut speed tuning.
+// NOTE: Each record uses 7 bytes of RAM. The Uno has very little to spare, so keep it small.
+// #define ENABLE_THC_CAPTURE // Default disabled. Uncomment to enable.
+#define THC_CAPTURE_BUFFER_SIZE 32 // Number of records (2-255).
+#define THC_CAPTURE_DECIMATION 4   // Record every Nth THC update. THC updates are 1ms. Integer (1-255).
+#define THC_CAPTURE_CHUNK_SIZE 8   // Max records drained per status report. Integer (1-255).
+
+// Length of the Z step pulses the THC makes from the tick ISR, which busy-waits for it. The stepper
+// ISR is held off meanwhile, so keep this short. The planner's own pulses use the $0 setting.
+#define THC_Z_STEP_PULSE_US 10 // Integer (microseconds)
+
+// When re-piercing after an arc loss, this is how long to wait for ARC_OK after re-firing the torch.
+// If the arc doesn't transfer in time, the torch is turned off and the machine remains in the hold.
+#define THC_REPIERCE_ARC_TIMEOUT 3.0 // Float (seconds)
+
+
 /* ---------------------------------------------------------------------------------------
    OEM Single File Configuration Option
 
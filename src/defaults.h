@@ -568,4 +568,33 @@
   #define DEFAULT_HOMING_PULLOFF 1.0 // mm
 #endif
 
+// Dual axis squaring offset. Common to all machine types, unless defined above.
+#ifndef DEFAULT_HOMING_DUAL_OFFSET
+  #define DEFAULT_HOMING_DUAL_OFFSET 0.0 // mm. 0 disables.
+#endif
+
+// Two-stage probing defaults. Common to all machine types, unless defined above.
+#ifndef DEFAULT_PROBE_RETRACT
+  #define DEFAULT_PROBE_RETRACT 0.0 // mm. 0 disables.
+  #define DEFAULT_PROBE_FEED_RATE 25.0 // mm/min
+#endif
+
+// Torch height control defaults. Common to all machine types, unless defined above.
+#ifndef DEFAULT_THC_TARGET
+  #define DEFAULT_THC_TARGET 0 // ADC counts (0-1023). THC off until set by $40 or $T=.
+  #define DEFAULT_THC_DEADBAND 10 // ADC counts (0-255)
+  #define DEFAULT_THC_ENABLE_THRESHOLD 30 // ADC counts (0-1023)
+  #define DEFAULT_THC_ARC_DELAY 3000 // msec (0-60000)
+  #define DEFAULT_THC_Z_RATE 12.0 // mm/min
+  #define DEFAULT_THC_Z_ACCEL 25.0 // mm/sec^2
+  #define DEFAULT_THC_SAMPLE_TIME 0 // msec (0-60000). 0 uses the $40 or $T= setpoint.
+  #define DEFAULT_THC_VELOCITY_THRESHOLD 80 // percent (0-100). 0 disables anti-dive.
+  #define DEFAULT_THC_KERF_SLOPE 0 // ADC counts/msec (0-255). 0 disables kerf crossing detection.
+  #define DEFAULT_THC_KERF_HOLD_TIME 250 // msec (0-60000)
+  #define DEFAULT_THC_ARC_LOST_TIME 100 // msec (0-60000). 0 disables arc loss detection.
+  #define DEFAULT_THC_REPIERCE_RETRIES 0 // (0-255). 0 holds on arc loss until cycle start.
+  #define DEFAULT_THC_PIERCE_DELAY 500 // msec (0-60000)
+  #define DEFAULT_THC_MAX_EXCURSION 10.0 // mm. 0 disables.
+#endif
+
 #endif
@@ -37,54 +37,70 @@
 /* Define to reduce code size. */
 #define EEPROM_IGNORE_SELFPROG //!< Remove SPM flag polling.
 
-/*! \brief  Read byte from EEPROM.
- *
- *  This function reads one byte from a given EEPROM address.
+/* Background write queue. Bytes are programmed one at a time by the EE_READY interrupt, so the
+ * stepper, serial and THC interrupts keep running during the ~3.4 ms programming time of each byte. */
+#ifndef EEPROM_WRITE_QUEUE_SIZE
+	#define EEPROM_WRITE_QUEUE_SIZE 4 //!< Pending byte writes. Longer writes wait for room as they are queued.
+#endif
+
+typedef struct {
+	unsigned int addr;
+	unsigned char value;
+} eeprom_write_t;
+
+static eeprom_write_t eeprom_queue[EEPROM_WRITE_QUEUE_SIZE];
+static volatile unsigned char eeprom_queue_head;
+static volatile unsigned char eeprom_queue_tail;
+
+/*! \brief  Find a pending write to an EEPROM address.
  *
- *  \note  The CPU is halted for 4 clock cycles during EEPROM read.
+ *  \note  Must be called with interrupts disabled.
  *
- *  \param  addr  EEPROM address to read from.
- *  \return  The byte read from the EEPROM address.
+ *  \param  addr  EEPROM address to look up.
+ *  \return  Pointer to the newest queued write to the address, or 0 if none.
  */
-unsigned char eeprom_get_char( unsigned int addr )
+static eeprom_write_t *eeprom_find_pending( unsigned int addr )
 {
-	do {} while( EECR & (1<<EEPE) ); // Wait for completion of previous write.
-	EEAR = addr; // Set EEPROM address register.
-	EECR = (1<<EERE); // Start EEPROM read operation.
-	return EEDR; // Return the byte read from EEPROM.
+	unsigned char idx = eeprom_queue_head;
+	while( idx != eeprom_queue_tail ) {
+		if( idx == 0 ) { idx = EEPROM_WRITE_QUEUE_SIZE; }
+		idx--;
+		if( eeprom_queue[idx].addr == addr ) { return &eeprom_queue[idx]; }
+	}
+	return 0;
 }
 
-/*! \brief  Write byte to EEPROM.
- *
- *  This function writes one byte to a given EEPROM address.
- *  The differences between the existing byte and the new value is used
- *  to select the most efficient EEPROM programming mode.
+/*! \brief  Program the next queued byte into EEPROM.
  *
- *  \note  The CPU is halted for 2 clock cycles during EEPROM programming.
- *
- *  \note  When this function returns, the new EEPROM value is not available
- *         until the EEPROM programming time has passed. The EEPE bit in EECR
- *         should be polled to check whether the programming is finished.
+ *  The differences between the existing byte and the new value are used to
+ *  select the most efficient EEPROM programming mode. Unchanged bytes are
+ *  skipped. Disables the EE_READY interrupt once the queue is empty.
  *
- *  \note  The EEPROM_GetChar() function checks the EEPE bit automatically.
+ *  \note  Must be called with interrupts disabled and no write in progress.
  *
- *  \param  addr  EEPROM address to write to.
- *  \param  new_value  New EEPROM value.
+ *  \note  The CPU is halted for 2 clock cycles during EEPROM programming.
  */
-void eeprom_put_char( unsigned int addr, unsigned char new_value )
+static void eeprom_write_next()
 {
 	char old_value; // Old EEPROM value.
 	char diff_mask; // Difference mask, i.e. old value XOR new value.
+	unsigned char tail = eeprom_queue_tail;
+	unsigned char new_value;
 
-	cli(); // Ensure atomic operation for the write operation.
-	
-	do {} while( EECR & (1<<EEPE) ); // Wait for completion of previous write.
+	if( tail == eeprom_queue_head ) {
+		EECR &= ~(1<<EERIE); // Nothing left to write.
+		return;
+	}
 	#ifndef EEPROM_IGNORE_SELFPROG
-	do {} while( SPMCSR & (1<<SELFPRGEN) ); // Wait for completion of SPM.
+	if( SPMCSR & (1<<SELFPRGEN) ) { return; } // Retry once SPM completes.
 	#endif
-	
-	EEAR = addr; // Set EEPROM address register.
-	EECR = (1<<EERE); // Start EEPROM read operation.
+
+	new_value = eeprom_queue[tail].value;
+	EEAR = eeprom_queue[tail].addr; // Set EEPROM address register.
+	if( ++tail == EEPROM_WRITE_QUEUE_SIZE ) { tail = 0; }
+	eeprom_queue_tail = tail;
+
+	EECR = (1<<EERE) | (1<<EERIE); // Start EEPROM read operation.
 	old_value = EEDR; // Get old EEPROM value.
 	diff_mask = old_value ^ new_value; // Get bit differences.
 	
@@ -97,13 +113,13 @@ void eeprom_put_char( unsigned int addr, unsigned char new_value )
 			// Now we know that some bits need to be programmed to '0' also.
 			
 			EEDR = new_value; // Set EEPROM data register.
-			EECR = (1<<EEMPE) | // Set Master Write Enable bit...
+			EECR = (1<<EERIE) | (1<<EEMPE) | // Set Master Write Enable bit...
 			       (0<<EEPM1) | (0<<EEPM0); // ...and Erase+Write mode.
 			EECR |= (1<<EEPE);  // Start Erase+Write operation.
 		} else {
 			// Now we know that all bits should be erased.
 
-			EECR = (1<<EEMPE) | // Set Master Write Enable bit...
+			EECR = (1<<EERIE) | (1<<EEMPE) | // Set Master Write Enable bit...
 			       (1<<EEPM0);  // ...and Erase-only mode.
 			EECR |= (1<<EEPE);  // Start Erase-only operation.
 		}
@@ -115,13 +131,112 @@ void eeprom_put_char( unsigned int addr, unsigned char new_value )
 			// Now we know that _some_ bits need to the programmed to '0'.
 			
 			EEDR = new_value;   // Set EEPROM data register.
-			EECR = (1<<EEMPE) | // Set Master Write Enable bit...
+			EECR = (1<<EERIE) | (1<<EEMPE) | // Set Master Write Enable bit...
 			       (1<<EEPM1);  // ...and Write-only mode.
 			EECR |= (1<<EEPE);  // Start Write-only operation.
 		}
 	}
-	
-	sei(); // Restore interrupt flag state.
+}
+
+/*! \brief  Read byte from EEPROM.
+ *
+ *  This function reads one byte from a given EEPROM address. Writes still
+ *  waiting in the queue are returned in place of the stored byte.
+ *
+ *  \note  The CPU is halted for 4 clock cycles during EEPROM read.
+ *
+ *  \param  addr  EEPROM address to read from.
+ *  \return  The byte read from the EEPROM address.
+ */
+unsigned char eeprom_get_char( unsigned int addr )
+{
+	unsigned char sreg, value;
+	eeprom_write_t *pending;
+	for(;;) {
+		do {} while( EECR & (1<<EEPE) ); // Wait for completion of previous write.
+		sreg = SREG;
+		cli(); // Keep the EE_READY interrupt from popping the queue or starting a write.
+		pending = eeprom_find_pending(addr);
+		if( pending ) {
+			value = pending->value;
+			break;
+		}
+		if( !(EECR & (1<<EEPE)) ) {
+			EEAR = addr; // Set EEPROM address register.
+			EECR = (1<<EERE) | (EECR & (1<<EERIE)); // Start EEPROM read operation.
+			value = EEDR; // Get the byte read from EEPROM.
+			break;
+		}
+		SREG = sreg; // A queued write started in the meantime. Wait for it.
+	}
+	SREG = sreg;
+	return value;
+}
+
+/*! \brief  Write byte to EEPROM.
+ *
+ *  This function queues one byte for writing to a given EEPROM address and
+ *  returns. A queued write to the same address is replaced. When the queue
+ *  is full, it waits for room with interrupts enabled, or programs queued
+ *  bytes itself if called with interrupts disabled (i.e. at power up).
+ *
+ *  \note  Pending writes are lost upon a power loss or hardware reset.
+ *
+ *  \param  addr  EEPROM address to write to.
+ *  \param  new_value  New EEPROM value.
+ */
+void eeprom_put_char( unsigned int addr, unsigned char new_value )
+{
+	unsigned char sreg = SREG;
+	unsigned char next_head;
+	eeprom_write_t *pending;
+
+	cli();
+	pending = eeprom_find_pending(addr);
+	if( pending ) {
+		pending->value = new_value;
+	} else {
+		next_head = eeprom_queue_head + 1;
+		if( next_head == EEPROM_WRITE_QUEUE_SIZE ) { next_head = 0; }
+		if( sreg & (1<<SREG_I) ) {
+			sei();
+			do {} while( next_head == eeprom_queue_tail ); // Let the EE_READY interrupt make room.
+			cli();
+		} else {
+			while( next_head == eeprom_queue_tail ) {
+				if( !(EECR & (1<<EEPE)) ) { eeprom_write_next(); }
+			}
+		}
+		eeprom_queue[eeprom_queue_head].addr = addr;
+		eeprom_queue[eeprom_queue_head].value = new_value;
+		eeprom_queue_head = next_head;
+		EECR |= (1<<EERIE); // Start the EE_READY interrupt, if not already running.
+	}
+	SREG = sreg;
+}
+
+/*! \brief  Free room in the write queue.
+ *
+ *  Lets a caller queue a long write a part at a time, rather than wait
+ *  in eeprom_put_char() for the queue to drain.
+ *
+ *  \return  Number of bytes that can be queued without waiting.
+ */
+unsigned char eeprom_queue_free()
+{
+	unsigned char used = eeprom_queue_head - eeprom_queue_tail; // Reads of each are atomic.
+	if( used >= EEPROM_WRITE_QUEUE_SIZE ) { used += EEPROM_WRITE_QUEUE_SIZE; } // Head wrapped.
+	return (EEPROM_WRITE_QUEUE_SIZE-1) - used;
+}
+
+/*! \brief  EEPROM ready interrupt.
+ *
+ *  Fires whenever the EEPROM is idle while enabled. Programs the next
+ *  queued byte.
+ */
+ISR(EE_READY_vect)
+{
+	eeprom_write_next();
 }
 
 // Extensions added as part of Grbl 
@@ -130,7 +245,9 @@ void eeprom_put_char( unsigned int addr, unsigned char new_value )
 void memcpy_to_eeprom_with_checksum(unsigned int destination, char *source, unsigned int size) {
   unsigned char checksum = 0;
   for(; size > 0; size--) { 
-    checksum = (checksum << 1) || (checksum >> 7);
+    // NOTE: Not the rotate it looks like. Grbl has always summed (checksum != 0), so it is kept as is
+    // for stored data to verify.
+    checksum = (checksum != 0);
     checksum += *source;
     eeprom_put_char(destination++, *(source++)); 
   }
@@ -141,7 +258,7 @@ int memcpy_from_eeprom_with_checksum(char *destination, unsigned int source, uns
   unsigned char data, checksum = 0;
   for(; size > 0; size--) { 
     data = eeprom_get_char(source++);
-    checksum = (checksum << 1) || (checksum >> 7);
+    checksum = (checksum != 0); // See above.
     checksum += data;    
     *(destination++) = data; 
   }
@@ -943,8 +943,23 @@ uint8_t gc_execute_line(char *line)
     // Update spindle control and apply spindle speed when enabling it in this block.
     // NOTE: All spindle state changes are synced, even in laser mode. Also, pl_data,
     // rather than gc_state, is used to manage laser state for non-laser motions.
+    float z_position = gc_state.position[Z_AXIS];
     spindle_sync(gc_block.modal.spindle, pl_data->spindle_speed);
     gc_state.modal.spindle = gc_block.modal.spindle;
+    // A torch off that leaves the torch raised by the THC syncs the parser to the actual Z. Move the
+    // values pre-computed from the old Z position along with it, so the rest of the block doesn't dive.
+    float z_shift = gc_state.position[Z_AXIS] - z_position;
+    if (z_shift != 0.0) {
+      if (gc_block.non_modal_command == NON_MODAL_SET_COORDINATE_OFFSET) {
+        if (bit_istrue(axis_words,bit(Z_AXIS))) { gc_block.values.xyz[Z_AXIS] += z_shift; }
+      } else if (gc_block.non_modal_command == NON_MODAL_SET_COORDINATE_DATA) {
+        if (bit_istrue(axis_words,bit(Z_AXIS)) && (gc_block.values.l == 20)) { gc_block.values.ijk[Z_AXIS] += z_shift; }
+      } else if (axis_command != AXIS_COMMAND_TOOL_LENGTH_OFFSET) {
+        // Targets that kept the old Z, or are incremental from it.
+        if (bit_isfalse(axis_words,bit(Z_AXIS)) || ((gc_block.modal.distance == DISTANCE_MODE_INCREMENTAL) &&
+            (gc_block.non_modal_command != NON_MODAL_ABSOLUTE_OVERRIDE))) { gc_block.values.xyz[Z_AXIS] += z_shift; }
+      }
+    }
   }
   pl_data->condition |= gc_state.modal.spindle; // Set condition flag for planner use.
 
@@ -1121,6 +1136,9 @@ uint8_t gc_execute_line(char *line)
         system_flag_wco_change(); // Set to refresh immediately just in case something altered.
         spindle_set_state(SPINDLE_DISABLE,0.0);
         coolant_set_state(COOLANT_DISABLE);
+        report_thc_cut();
+        mc_thc_unwind();
+        journal_store();
       }
       report_feedback_message(MESSAGE_PROGRAM_END);
     }
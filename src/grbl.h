@@ -33,6 +33,7 @@
 #include <util/delay.h>
 #include <math.h>
 #include <inttypes.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -60,16 +61,71 @@
 #include "spindle_control.h"
 #include "stepper.h"
 #include "jog.h"
+#include "journal.h"
 
 // ---------------------------------------------------------------------------------------
 // COMPILE-TIME ERROR CHECKING OF DEFINE VALUES:
+// THC tick. Timer2 is shared with the variable spindle PWM, which runs it in fast PWM mode. Then the
+// tick is the free-running overflow at a 1/8 prescaler, 128us with a 7.8kHz PWM. Without the PWM,
+// Timer2 runs in CTC mode for an exact 125us. The counter is never reloaded, so the tick doesn't
+// drift with interrupt latency. Millisecond tasks run when the microsecond remainder rolls over.
+// The tick ISR is in main.c.
+#ifdef VARIABLE_SPINDLE
+  #define THC_TICK_US 128
+  #define THC_TICK_vect TIMER2_OVF_vect
+#else
+  #define THC_TICK_US 125
+  #define THC_TICK_vect TIMER2_COMPA_vect
+#endif
+
 extern volatile bool jog_z_up;
 extern volatile bool jog_z_down;
 extern volatile bool machine_in_motion;
-extern volatile unsigned long micros;
-extern volatile unsigned long millis;
 extern volatile uint16_t analogVal;
 extern volatile uint16_t analogSetVal;
+extern volatile uint16_t thc_kerf_hold_count;
+extern volatile bool thc_z_clamped;
+
+// Computes the THC Z correction ramp and step window from settings. Called upon reset and setting changes.
+void thc_init();
+
+// Per-cut THC telemetry. Accumulated from torch on to torch off and reported once per cut.
+typedef struct {
+  uint32_t arc_time;      // Time with ARC_OK active, in msec.
+  uint32_t deadband_time; // Time the arc voltage was within the deadband while correcting, in msec.
+  uint32_t adc_sum;       // Sum of filtered arc voltage samples, taken once the arc has stabilized.
+  uint32_t adc_count;     // Number of filtered arc voltage samples.
+  uint16_t adc_min;       // Filtered arc voltage extremes in ADC counts.
+  uint16_t adc_max;
+  uint16_t up_count;      // Number of THC corrections started, by direction.
+  uint16_t down_count;
+  float distance;         // Distance moved with the torch on, in mm. Tallied by the planner.
+  int32_t offset;         // Net THC Z offset at torch off, in steps.
+} thc_cut_t;
+extern thc_cut_t thc_cut;
+
+// Clears and starts the per-cut record, unless one is already open. Called at torch on.
+void thc_cut_begin();
+
+// Copies the per-cut record at torch off and closes it. Returns false if no cut was started.
+uint8_t thc_cut_end(thc_cut_t *cut);
+
+#ifdef ENABLE_THC_CAPTURE
+  // Arc voltage capture record. Filled by the THC tick in main.c and drained by the status report.
+  #define THC_CAPTURE_ARC_OK_BIT 15 // Set in the adc field while ARC_OK is active.
+  typedef struct {
+    uint16_t time;   // Low 16 bits of millis at capture.
+    uint16_t adc;    // Arc voltage ADC value (10-bit) with the ARC_OK flag bit.
+    int8_t z_steps;  // Net THC Z steps since the prior record. Saturates at +/-127.
+    uint16_t feed;   // Realtime feed rate in mm/min.
+  } thc_capture_t;
+
+  // Copies the oldest pending capture record into the pointer. Returns false if none are pending.
+  uint8_t thc_capture_read(thc_capture_t *record);
+
+  // Returns and clears the number of records dropped due to a full capture buffer.
+  uint8_t thc_capture_get_dropped();
+#endif
 
 #define bit_get(p,m) ((p) & (m))
 #define bit_set(p,m) ((p) |= (m))
@@ -83,6 +139,14 @@ extern volatile uint16_t analogSetVal;
   #error "Required HOMING_CYCLE_0 not defined."
 #endif
 
+#if defined(VARIABLE_SPINDLE) && (SPINDLE_TCCRB_INIT_MASK != (1<<CS21))
+  #error "The THC tick shares Timer2 with the spindle PWM and requires its 1/8 prescaler. See cpu_map.h."
+#endif
+
+#if defined(ENABLE_INPUT_FILTER) && defined(ENABLE_SOFTWARE_DEBOUNCE)
+  #error "ENABLE_INPUT_FILTER and ENABLE_SOFTWARE_DEBOUNCE may not be enabled together."
+#endif
+
 #if defined(USE_SPINDLE_DIR_AS_ENABLE_PIN) && !defined(VARIABLE_SPINDLE)
   #error "USE_SPINDLE_DIR_AS_ENABLE_PIN may only be used with VARIABLE_SPINDLE enabled"
 #endif
@@ -126,6 +190,15 @@ extern volatile uint16_t analogSetVal;
   #error "Override refresh must be greater than zero."
 #endif
 
+#if defined(ENABLE_THC_CAPTURE)
+  #if (THC_CAPTURE_BUFFER_SIZE < 2) || (THC_CAPTURE_BUFFER_SIZE > 255)
+    #error "THC_CAPTURE_BUFFER_SIZE must be between 2 and 255."
+  #endif
+  #if (THC_CAPTURE_DECIMATION < 1) || (THC_CAPTURE_CHUNK_SIZE < 1)
+    #error "THC_CAPTURE_DECIMATION and THC_CAPTURE_CHUNK_SIZE must be greater than zero."
+  #endif
+#endif
+
 #if defined(ENABLE_DUAL_AXIS)
   #if !((DUAL_AXIS_SELECT == X_AXIS) || (DUAL_AXIS_SELECT == Y_AXIS))
     #error "Dual axis currently supports X or Y axes only."
@@ -37,6 +37,9 @@ uint8_t jog_execute(plan_line_data_t *pl_data, parser_block_t *gc_block)
   }
 
   // Valid jog command. Plan, set state, and execute.
+  #ifdef ENABLE_CONTINUOUS_JOG
+    jog_continuous_active = 0;
+  #endif
   mc_line(gc_block->values.xyz,pl_data);
   if (sys.state == STATE_IDLE) {
     if (plan_get_current_block() != NULL) { // Check if there is a block to execute.
@@ -48,3 +51,87 @@ uint8_t jog_execute(plan_line_data_t *pl_data, parser_block_t *gc_block)
 
   return(STATUS_OK);
 }
+
+
+#ifdef ENABLE_CONTINUOUS_JOG
+  volatile uint8_t jog_continuous;
+  volatile uint8_t jog_continuous_active;
+  volatile uint8_t jog_continuous_speed = JOG_CONTINUOUS_SPEED_MEDIUM;
+
+  // Plans a pending continuous jog as a single block to the end of travel, or to the soft limits if
+  // enabled, and starts it like a $J jog. A pending jog waits while the last one is being canceled,
+  // and is dropped if the machine is otherwise busy. The main loop runs this between lines, so the
+  // latency from the command byte to motion is one main loop pass plus the first segment prep.
+  void jog_continuous_execute()
+  {
+    if (!jog_continuous) { return; }
+    if (sys.state & STATE_JOG) { return; } // Wait for the jog cancel to complete.
+
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t direction = jog_continuous;
+    jog_continuous = 0;
+    SREG = sreg;
+    if (sys.state != STATE_IDLE) { return; }
+
+    // Jog distance is the shortest of the travels left along the jogged axes, so a combined
+    // direction keeps its angle. The rate is a percentage of the slowest jogged axis.
+    float target[N_AXIS];
+    float distance = SOME_LARGE_VALUE;
+    float rate = SOME_LARGE_VALUE;
+    float travel;
+    uint8_t axis_dir, idx;
+    for (idx=0; idx<N_AXIS; idx++) {
+      target[idx] = gc_state.position[idx];
+      axis_dir = (direction >> (2*idx)) & 0x03;
+      if (!axis_dir) { continue; }
+      if (axis_dir == 0x03) { return; } // Both directions on one axis. Invalid.
+      travel = -settings.max_travel[idx]; // NOTE: max_travel is stored as negative
+      if (bit_istrue(settings.flags,BITFLAG_SOFT_LIMIT_ENABLE)) {
+        // Travel left to the soft limit in the jog direction.
+        float limit_min = settings.max_travel[idx];
+        float limit_max = 0.0;
+        #ifdef HOMING_FORCE_SET_ORIGIN
+          if (bit_istrue(settings.homing_dir_mask,bit(idx))) {
+            limit_min = 0.0;
+            limit_max = -settings.max_travel[idx];
+          }
+        #endif
+        if (axis_dir & 0x01) { travel = limit_max-target[idx]; }
+        else { travel = target[idx]-limit_min; }
+      }
+      if (travel < distance) { distance = travel; }
+      if (settings.max_rate[idx] < rate) { rate = settings.max_rate[idx]; }
+    }
+    if ((rate == SOME_LARGE_VALUE) || (distance <= 0.0)) { return; } // No direction, or at the limit.
+
+    for (idx=0; idx<N_AXIS; idx++) {
+      axis_dir = (direction >> (2*idx)) & 0x03;
+      if (axis_dir == 0x01) { target[idx] += distance; }
+      else if (axis_dir == 0x02) { target[idx] -= distance; }
+    }
+    if (bit_istrue(settings.flags,BITFLAG_SOFT_LIMIT_ENABLE)) {
+      if (system_check_travel_limits(target)) { return; }
+    }
+
+    // Initialize planner data to current spindle and coolant modal state, as for a $J jog.
+    plan_line_data_t plan_data;
+    plan_line_data_t *pl_data = &plan_data;
+    memset(pl_data,0,sizeof(plan_line_data_t));
+    pl_data->feed_rate = rate*jog_continuous_speed/100;
+    pl_data->spindle_speed = gc_state.spindle_speed;
+    pl_data->condition = (gc_state.modal.spindle | gc_state.modal.coolant | PL_COND_FLAG_NO_FEED_OVERRIDE);
+    #ifdef USE_LINE_NUMBERS
+      pl_data->line_number = JOG_LINE_NUMBER;
+    #endif
+
+    jog_continuous_active = direction;
+    mc_line(target,pl_data);
+    if (plan_get_current_block() != NULL) {
+      sys.state = STATE_JOG;
+      st_prep_buffer();
+      st_wake_up();
+    }
+    memcpy(gc_state.position, target, sizeof(target)); // Synced again upon the jog cancel.
+  }
+#endif
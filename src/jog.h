@@ -29,4 +29,15 @@
 // Sets up valid jog motion received from g-code parser, checks for soft-limits, and executes the jog.
 uint8_t jog_execute(plan_line_data_t *pl_data, parser_block_t *gc_block);
 
+#ifdef ENABLE_CONTINUOUS_JOG
+  #define JOG_CONTINUOUS_MASK 0x3F // Direction bits of the CMD_JOG_CONTINUOUS value byte. Two per axis, positive first.
+
+  extern volatile uint8_t jog_continuous;        // Pending continuous jog direction, set by the serial RX ISR.
+  extern volatile uint8_t jog_continuous_active; // Direction of the continuous jog in progress.
+  extern volatile uint8_t jog_continuous_speed;  // Continuous jog speed in percent of max rate.
+
+  // Plans and starts a pending continuous jog. Called by the main loop.
+  void jog_continuous_execute();
+#endif
+
 #endif
@@ -0,0 +1,129 @@
+/*
+  journal.c - Wear-leveled EEPROM journal for frequently updated values
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "grbl.h"
+
+journal_t journal;
+
+static uint8_t journal_slot;  // Slot holding the newest record. The next store goes to the one after.
+static uint8_t journal_dirty; // Cuts tallied since the last store.
+
+static uint8_t journal_write_idx = sizeof(journal_t); // Next byte to queue. sizeof(journal_t) when done.
+
+
+// CRC-8 (poly 0x07) of a record, up to the CRC byte itself.
+static uint8_t journal_crc(journal_t *record)
+{
+  uint8_t *data = (uint8_t*)record;
+  uint8_t crc = 0;
+  uint8_t idx, bit;
+  for (idx=0; idx < offsetof(journal_t, crc); idx++) {
+    crc ^= data[idx];
+    for (bit=0; bit < 8; bit++) {
+      if (crc & 0x80) { crc = (crc << 1) ^ 0x07; }
+      else { crc <<= 1; }
+    }
+  }
+  return(crc);
+}
+
+
+static uint16_t journal_slot_addr(uint8_t slot)
+{
+  return(EEPROM_ADDR_JOURNAL + slot*sizeof(journal_t));
+}
+
+
+void journal_init()
+{
+  journal_t record;
+  uint8_t slot, idx;
+  uint8_t found = false;
+  memset(&journal, 0, sizeof(journal_t));
+  journal_slot = JOURNAL_N_SLOTS-1; // First store goes to slot 0 when the journal is empty.
+  journal_dirty = false;
+  journal_write_idx = sizeof(journal_t); // Drop any record still being written.
+  for (slot=0; slot < JOURNAL_N_SLOTS; slot++) {
+    uint16_t addr = journal_slot_addr(slot);
+    for (idx=0; idx < sizeof(journal_t); idx++) { ((uint8_t*)&record)[idx] = eeprom_get_char(addr+idx); }
+    if (record.crc != journal_crc(&record)) { continue; } // Erased, or torn by a power loss.
+    // Newest is the highest sequence number. Compared as a difference to allow it to wrap.
+    if (!found || ((int16_t)(record.sequence-journal.sequence) > 0)) {
+      memcpy(&journal, &record, sizeof(journal_t));
+      journal_slot = slot;
+      found = true;
+    }
+  }
+}
+
+
+void journal_reset()
+{
+  journal_init(); // Locate the newest record, so the empty one stored supersedes it.
+  uint16_t sequence = journal.sequence;
+  memset(&journal, 0, sizeof(journal_t));
+  journal.sequence = sequence;
+  journal_store();
+}
+
+
+void journal_add_cut(uint32_t arc_time)
+{
+  // NOTE: A record still being written is abandoned, as the rest of it would no longer match its CRC.
+  // Its slot is left torn, as by a power loss, and the cut is stored with the next record.
+  journal_write_idx = sizeof(journal_t);
+  journal.cut_count++;
+  journal.arc_time += arc_time;
+  journal_dirty = true;
+}
+
+
+void journal_store()
+{
+  if (++journal_slot >= JOURNAL_N_SLOTS) { journal_slot = 0; }
+  journal.sequence++;
+  journal.thc_setpoint = analogSetVal;
+  uint8_t sreg = SREG;
+  cli();
+  memcpy(journal.position, sys_position, sizeof(sys_position));
+  journal.position[Z_AXIS] += sys_thc_offset;
+  SREG = sreg;
+  journal.crc = journal_crc(&journal);
+  // NOTE: A store while the last one is still being written abandons it. Its slot is left torn
+  // and fails the CRC check, and the record before it stays valid until this one completes.
+  journal_write_idx = 0;
+  journal_dirty = false;
+  journal_write();
+}
+
+
+void journal_write()
+{
+  // NOTE: Bytes are written in order with the CRC last. A torn write fails the CRC check.
+  uint16_t addr = journal_slot_addr(journal_slot);
+  while ((journal_write_idx < sizeof(journal_t)) && eeprom_queue_free()) {
+    eeprom_put_char(addr+journal_write_idx, ((uint8_t*)&journal)[journal_write_idx]);
+    journal_write_idx++;
+  }
+}
+
+
+void journal_sync()
+{
+  if (journal_dirty) { journal_store(); }
+}
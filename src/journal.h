@@ -0,0 +1,58 @@
+/*
+  journal.h - Wear-leveled EEPROM journal for frequently updated values
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef journal_h
+#define journal_h
+
+// Journal record. Each store writes the next slot of the EEPROM journal region in turn, so no
+// single cell takes every write. The sequence number orders the slots and the CRC rejects a
+// record torn by a power loss mid-write, leaving the one before it as the newest valid record.
+// A record is larger than the EEPROM write queue, so it is queued a part at a time without
+// waiting, and the realtime checkpoints queue the rest as the EE_READY interrupt programs them.
+typedef struct {
+  uint16_t sequence;
+  uint16_t thc_setpoint;      // Last THC arc voltage setpoint. Restored upon power-up.
+  uint32_t cut_count;         // Completed cuts.
+  uint32_t arc_time;          // Total arc on time in msec.
+  int32_t position[N_AXIS];   // Machine position in steps when last stored.
+  uint8_t crc;
+} journal_t;
+extern journal_t journal;
+
+#define JOURNAL_N_SLOTS (EEPROM_JOURNAL_SIZE/sizeof(journal_t))
+
+// Loads the newest valid record from EEPROM. Called by settings_init().
+void journal_init();
+
+// Clears the counters and stores an empty record.
+void journal_reset();
+
+// Tallies a completed cut. Stored upon the next journal_sync().
+void journal_add_cut(uint32_t arc_time);
+
+// Stores a record of the current position and setpoint, and any tallied cuts.
+void journal_store();
+
+// Stores a record only if a cut was tallied since the last store.
+void journal_sync();
+
+// Queues the rest of a stored record for writing, as room frees up in the EEPROM write queue.
+// Called by the main loop.
+void journal_write();
+
+#endif
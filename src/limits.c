@@ -38,6 +38,60 @@
   #define DUAL_AXIS_CHECK_TRIGGER_2   bit(2)
 #endif
 
+// Homing switch latch. During a homing approach, the limit pin change interrupt records the
+// position the instant a cycle axis switch triggers and locks the axis out, instead of waiting
+// for the homing loop to poll it. Overshoot is then bounded by the ISR latency, not the loop.
+static uint8_t homing_latch_mask;         // Switches still armed. Bit per axis, N_AXIS for the dual.
+static volatile uint8_t homing_latched;   // Switches latched in the current approach.
+static int32_t homing_latch_position[N_AXIS];
+#ifdef ENABLE_DUAL_AXIS
+  static int32_t homing_latch_position_dual;
+#endif
+static uint8_t homing_decelerate;         // Seek approach decelerates past the switch. See config.h.
+
+
+// Latches newly triggered homing switches. Called by the limit pin change interrupt during a
+// homing approach, and by the homing loop with interrupts disabled.
+static void limits_homing_latch()
+{
+  uint8_t limit_state = limits_get_state() & homing_latch_mask;
+  if (!limit_state) { return; }
+  homing_latch_mask &= ~limit_state;
+  homing_latched |= limit_state;
+  uint8_t idx;
+  for (idx=0; idx<N_AXIS; idx++) {
+    if (limit_state & bit(idx)) {
+      homing_latch_position[idx] = sys_position[idx];
+      #ifndef COREXY
+        if (!homing_decelerate) { sys.homing_axis_lock &= ~get_step_pin_mask(idx); }
+      #endif
+    }
+  }
+  #ifdef ENABLE_DUAL_AXIS
+    if (limit_state & bit(N_AXIS)) {
+      homing_latch_position_dual = sys_position[DUAL_AXIS_SELECT];
+      if (!homing_decelerate) { sys.homing_axis_lock_dual = 0; }
+    }
+  #endif
+}
+
+
+// Starts the decelerated stop of a seek approach, once. Axis locks are held until the stop.
+static void limits_homing_hold()
+{
+  if (!(sys.step_control & STEP_CONTROL_EXECUTE_HOLD)) {
+    st_update_plan_block_parameters(); // Notify stepper module to recompute for hold deceleration.
+    sys.step_control |= STEP_CONTROL_EXECUTE_HOLD;
+  }
+}
+
+
+#ifdef ENABLE_INPUT_FILTER
+  static uint8_t filter_enabled;  // Set while hard limits are enabled, outside of homing.
+  static input_filter_t limit_filter; // Hard limit input filter.
+#endif
+
+
 void limits_init()
 {
   LIMIT_DDR &= ~(LIMIT_MASK); // Set as input pins
@@ -49,8 +103,21 @@ void limits_init()
   #endif
 
   if (bit_istrue(settings.flags,BITFLAG_HARD_LIMIT_ENABLE)) {
-    LIMIT_PCMSK |= LIMIT_MASK; // Enable specific pins of the Pin Change Interrupt
-    PCICR |= (1 << LIMIT_INT); // Enable Pin Change Interrupt
+    #ifdef ENABLE_INPUT_FILTER
+      // Sampled by the THC tick instead. A switch engaged now alarms only once released and re-engaged,
+      // as with the pin change interrupt.
+      uint8_t sreg = SREG;
+      cli();
+      limit_filter.stable = (LIMIT_PIN & LIMIT_MASK);
+      limit_filter.sample = limit_filter.stable;
+      limit_filter.count = 0;
+      limit_filter.elapsed = 0;
+      filter_enabled = true;
+      SREG = sreg;
+    #else
+      LIMIT_PCMSK |= LIMIT_MASK; // Enable specific pins of the Pin Change Interrupt
+      PCICR |= (1 << LIMIT_INT); // Enable Pin Change Interrupt
+    #endif
   } else {
     limits_disable();
   }
@@ -68,6 +135,9 @@ void limits_disable()
 {
   LIMIT_PCMSK &= ~LIMIT_MASK;  // Disable specific pins of the Pin Change Interrupt
   PCICR &= ~(1 << LIMIT_INT);  // Disable Pin Change Interrupt
+  #ifdef ENABLE_INPUT_FILTER
+    filter_enabled = false;
+  #endif
 }
 
 
@@ -95,6 +165,29 @@ uint8_t limits_get_state()
 }
 
 
+#ifdef ENABLE_INPUT_FILTER
+  void limits_filter_tick()
+  {
+    if (!filter_enabled) { return; }
+    uint8_t pin = (LIMIT_PIN & LIMIT_MASK);
+    uint8_t result = input_filter_update(&limit_filter, pin);
+    if (result == INPUT_FILTER_GLITCH) { sys_buffer_stats.limit_glitches++; }
+    if (result != INPUT_FILTER_CHANGED) { return; }
+
+    // Change accepted. Alarm if a limit is now triggered, as the pin change interrupt would.
+    if (limit_filter.latency > sys_buffer_stats.limit_latency_max) { sys_buffer_stats.limit_latency_max = limit_filter.latency; }
+    #ifdef INVERT_LIMIT_PIN_MASK
+      pin ^= INVERT_LIMIT_PIN_MASK;
+    #endif
+    if (bit_isfalse(settings.flags,BITFLAG_INVERT_LIMIT_PINS)) { pin ^= LIMIT_MASK; }
+    if (pin && (sys.state != STATE_ALARM) && !(sys_rt_exec_alarm)) {
+      mc_reset(); // Initiate system kill.
+      system_set_exec_alarm(EXEC_ALARM_HARD_LIMIT); // Indicate hard limit critical event
+    }
+  }
+#endif
+
+
 // This is the Limit Pin Change Interrupt, which handles the hard limit feature. A bouncing
 // limit switch can cause a lot of problems, like false readings and multiple interrupt calls.
 // If a switch is triggered at all, something bad has happened and treat it as such, regardless
@@ -109,6 +202,7 @@ uint8_t limits_get_state()
 #ifndef ENABLE_SOFTWARE_DEBOUNCE
   ISR(LIMIT_INT_vect) // DEFAULT: Limit pin change interrupt process.
   {
+    if (sys.state == STATE_HOMING) { limits_homing_latch(); return; } // Only enabled in homing approaches.
     // Ignore limit switches if already in an alarm state or in-process of executing an alarm.
     // When in the alarm state, Grbl should have been reset or will force a reset, so any pending
     // moves in the planner and serial buffers are all cleared and newly sent blocks will be
@@ -131,7 +225,11 @@ uint8_t limits_get_state()
   }
 #else // OPTIONAL: Software debounce limit pin routine.
   // Upon limit pin change, enable watchdog timer to create a short delay. 
-  ISR(LIMIT_INT_vect) { if (!(WDTCSR & (1<<WDIE))) { WDTCSR |= (1<<WDIE); } }
+  ISR(LIMIT_INT_vect)
+  {
+    if (sys.state == STATE_HOMING) { limits_homing_latch(); return; } // Latch the first edge. Not debounced.
+    if (!(WDTCSR & (1<<WDIE))) { WDTCSR |= (1<<WDIE); }
+  }
   ISR(WDT_vect) // Watchdog timer ISR
   {
     WDTCSR &= ~(1<<WDIE); // Disable watchdog timer. 
@@ -182,6 +280,7 @@ void limits_go_home(uint8_t cycle_mask)
     fail_distance = min(fail_distance, DUAL_AXIS_HOMING_FAIL_DISTANCE_MAX);
     fail_distance = max(fail_distance, DUAL_AXIS_HOMING_FAIL_DISTANCE_MIN);
     int32_t dual_fail_distance = trunc(fail_distance*settings.steps_per_mm[DUAL_AXIS_SELECT]);
+    int32_t dual_skew = 0;
     // int32_t dual_fail_distance = trunc((DUAL_AXIS_HOMING_TRIGGER_FAIL_DISTANCE)*settings.steps_per_mm[DUAL_AXIS_SELECT]);
   #endif
   float target[N_AXIS];
@@ -237,7 +336,9 @@ void limits_go_home(uint8_t cycle_mask)
             sys_position[Z_AXIS] = 0;
           }
         #else
-          sys_position[idx] = 0;
+          // After a decelerated seek, the axis is past its switch. Reference the latched trigger point.
+          if (homing_decelerate) { sys_position[idx] -= homing_latch_position[idx]; }
+          else { sys_position[idx] = 0; }
         #endif
         // Set target direction based on cycle mask and homing cycle approach state.
         // NOTE: This happens to compile smaller than any other implementation tried.
@@ -259,6 +360,22 @@ void limits_go_home(uint8_t cycle_mask)
     homing_rate *= sqrt(n_active_axis); // [sqrt(N_AXIS)] Adjust so individual axes all move at homing rate.
     sys.homing_axis_lock = axislock;
 
+    // Arm the switch latch for approaches. A lone axis seeking its switch may decelerate past it.
+    // A dual axis holds at its first switch, and the other side is latched during the overtravel.
+    homing_decelerate = false;
+    #if defined(HOMING_SEEK_DECELERATE) && !defined(COREXY)
+      if (approach && (n_cycle == (2*N_HOMING_LOCATE_CYCLE+1)) && (n_active_axis == 1)) { homing_decelerate = true; }
+    #endif
+    if (approach) {
+      homing_latched = 0;
+      homing_latch_mask = cycle_mask;
+      #ifdef ENABLE_DUAL_AXIS
+        if (sys.homing_axis_lock_dual) { homing_latch_mask |= bit(N_AXIS); }
+      #endif
+      LIMIT_PCMSK |= LIMIT_MASK; // Enable specific pins of the Pin Change Interrupt
+      PCICR |= (1 << LIMIT_INT); // Enable Pin Change Interrupt
+    }
+
     // Perform homing cycle. Planner buffer should be empty, as required to initiate the homing cycle.
     pl_data->feed_rate = homing_rate; // Set current homing rate.
     plan_buffer_line(target, pl_data); // Bypass mc_line(). Directly plan homing motion.
@@ -268,39 +385,51 @@ void limits_go_home(uint8_t cycle_mask)
     st_wake_up(); // Initiate motion
     do {
       if (approach) {
-        // Check limit state. Lock out cycle axes when they change.
-        limit_state = limits_get_state();
+        // Check latched limit state. Lock out cycle axes when they change. Done atomically, so the
+        // lock written back can't undo one just set by the pin change interrupt.
+        uint8_t sreg = SREG;
+        cli();
+        limits_homing_latch(); // Catches switches engaged before the approach, which raise no pin change.
+        limit_state = homing_latched;
+        homing_latched = 0; // Each latched switch is handled once.
         for (idx=0; idx<N_AXIS; idx++) {
           if (axislock & step_pin[idx]) {
             if (limit_state & (1 << idx)) {
+              #if defined(ENABLE_DUAL_AXIS) && !defined(COREXY)
+                if (idx == DUAL_AXIS_SELECT) { dual_axis_async_check |= DUAL_AXIS_CHECK_TRIGGER_1; }
+              #endif
+              if (homing_decelerate) {
+                // Switch found. Decelerate to a stop past it. Axislock is held until the stop.
+                limits_homing_hold();
+                continue;
+              }
               #ifdef COREXY
                 if (idx==Z_AXIS) { axislock &= ~(step_pin[Z_AXIS]); }
                 else { axislock &= ~(step_pin[A_MOTOR]|step_pin[B_MOTOR]); }
               #else
                 axislock &= ~(step_pin[idx]);
-                #ifdef ENABLE_DUAL_AXIS
-                  if (idx == DUAL_AXIS_SELECT) { dual_axis_async_check |= DUAL_AXIS_CHECK_TRIGGER_1; }
-                #endif
               #endif
             }
           }
         }
         sys.homing_axis_lock = axislock;
         #ifdef ENABLE_DUAL_AXIS
-          if (sys.homing_axis_lock_dual) { // NOTE: Only true when homing dual axis.
-            if (limit_state & (1 << N_AXIS)) { 
-              sys.homing_axis_lock_dual = 0;
-              dual_axis_async_check |= DUAL_AXIS_CHECK_TRIGGER_2;
-            }
+          if (limit_state & (1 << N_AXIS)) { // NOTE: Only latched when homing dual axis.
+            dual_axis_async_check |= DUAL_AXIS_CHECK_TRIGGER_2;
+            if (homing_decelerate) { limits_homing_hold(); }
+            else { sys.homing_axis_lock_dual = 0; }
           }
-          
+        #endif
+        SREG = sreg;
+
+        #ifdef ENABLE_DUAL_AXIS
           // When first dual axis limit triggers, record position and begin checking distance until other limit triggers. Bail upon failure.
           if (dual_axis_async_check) {
             if (dual_axis_async_check & DUAL_AXIS_CHECK_ENABLE) {
               if (( dual_axis_async_check &  (DUAL_AXIS_CHECK_TRIGGER_1 | DUAL_AXIS_CHECK_TRIGGER_2)) == (DUAL_AXIS_CHECK_TRIGGER_1 | DUAL_AXIS_CHECK_TRIGGER_2)) {
                 dual_axis_async_check = DUAL_AXIS_CHECK_DISABLE;
               } else {
-                if (abs(dual_trigger_position - sys_position[DUAL_AXIS_SELECT]) > dual_fail_distance) {
+                if (labs(dual_trigger_position - sys_position[DUAL_AXIS_SELECT]) > dual_fail_distance) {
                   system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_DUAL_APPROACH);
                   mc_reset();
                   protocol_execute_realtime();
@@ -326,14 +455,22 @@ void limits_go_home(uint8_t cycle_mask)
         if (rt_exec & EXEC_SAFETY_DOOR) { system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_DOOR); }
         // Homing failure condition: Limit switch still engaged after pull-off motion
         if (!approach && (limits_get_state() & cycle_mask)) { system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_PULLOFF); }
-        // Homing failure condition: Limit switch not found during approach.
-        if (approach && (rt_exec & EXEC_CYCLE_STOP)) { system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_APPROACH); }
+        // Homing failure condition: Limit switch not found during approach. Not a decelerated seek stop.
+        if (approach && (rt_exec & EXEC_CYCLE_STOP) && !(sys.step_control & STEP_CONTROL_EXECUTE_HOLD)) {
+          system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_APPROACH);
+        }
+        #ifdef ENABLE_DUAL_AXIS
+          // Homing failure condition: Decelerated dual axis seek stopped before its other side latched.
+          if (approach && (rt_exec & EXEC_CYCLE_STOP) && homing_decelerate && homing_latch_mask) {
+            system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_DUAL_APPROACH);
+          }
+        #endif
         if (sys_rt_exec_alarm) {
           mc_reset(); // Stop motors, if they are running.
           protocol_execute_realtime();
           return;
         } else {
-          // Pull-off motion complete. Disable CYCLE_STOP from executing.
+          // Pull-off motion or decelerated seek complete. Disable CYCLE_STOP from executing.
           system_clear_exec_state_flag(EXEC_CYCLE_STOP);
           break;
         }
@@ -345,9 +482,49 @@ void limits_go_home(uint8_t cycle_mask)
       } while (STEP_MASK & axislock);
     #endif
 
+    limits_disable(); // Disarm the switch latch.
     st_reset(); // Immediately force kill steppers and reset step segment buffer.
     delay_ms(settings.homing_debounce_delay); // Delay to allow transient dynamics to dissipate.
 
+    #ifdef ENABLE_DUAL_AXIS
+      // After the last locate approach, both dual axis switches were latched at the feed rate. Their
+      // difference is the switch skew. Square the gantry by stepping one motor away from its switch
+      // by the offset, the dual motor when positive and the main when negative, before the final
+      // pull-off moves both. The motor held at its switch is the axis reference.
+      if (approach && (n_cycle == 1) && (cycle_mask & bit(DUAL_AXIS_SELECT))) {
+        dual_skew = homing_latch_position_dual - homing_latch_position[DUAL_AXIS_SELECT];
+        if (settings.homing_dual_offset != 0.0) {
+          system_convert_array_steps_to_mpos(target,sys_position);
+          if (bit_istrue(settings.homing_dir_mask,bit(DUAL_AXIS_SELECT))) { target[DUAL_AXIS_SELECT] += fabs(settings.homing_dual_offset); }
+          else { target[DUAL_AXIS_SELECT] -= fabs(settings.homing_dual_offset); }
+          if (settings.homing_dual_offset > 0.0) {
+            sys.homing_axis_lock = 0;
+            sys.homing_axis_lock_dual = step_pin_dual;
+          } else {
+            sys.homing_axis_lock = step_pin[DUAL_AXIS_SELECT];
+            sys.homing_axis_lock_dual = 0;
+          }
+          pl_data->feed_rate = settings.homing_feed_rate;
+          plan_buffer_line(target, pl_data); // Bypass mc_line(). Directly plan squaring motion.
+          sys.step_control = STEP_CONTROL_EXECUTE_SYS_MOTION;
+          st_prep_buffer();
+          st_wake_up();
+          do {
+            st_prep_buffer();
+            if (sys_rt_exec_state & (EXEC_SAFETY_DOOR | EXEC_RESET)) {
+              if (sys_rt_exec_state & EXEC_RESET) { system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_RESET); }
+              else { system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_DOOR); }
+              mc_reset();
+              protocol_execute_realtime();
+              return;
+            }
+          } while (!(sys_rt_exec_state & EXEC_CYCLE_STOP));
+          system_clear_exec_state_flag(EXEC_CYCLE_STOP);
+          st_reset();
+        }
+      }
+    #endif
+
     // Reverse direction and reset homing rate for locate cycle(s).
     approach = !approach;
 
@@ -402,6 +579,10 @@ void limits_go_home(uint8_t cycle_mask)
     }
   }
   sys.step_control = STEP_CONTROL_NORMAL_OP; // Return step control to normal operation.
+
+  #ifdef ENABLE_DUAL_AXIS
+    if (cycle_mask & bit(DUAL_AXIS_SELECT)) { report_homing_dual_skew(dual_skew/settings.steps_per_mm[DUAL_AXIS_SELECT]); }
+  #endif
 }
 
 
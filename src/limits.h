@@ -32,6 +32,50 @@ void limits_disable();
 // Returns limit state as a bit-wise uint8 variable.
 uint8_t limits_get_state();
 
+#ifdef ENABLE_INPUT_FILTER
+  // Samples and filters the hard limit inputs. Called by the THC tick ISR.
+  void limits_filter_tick();
+
+  // Input filter results.
+  #define INPUT_FILTER_IDLE 0     // No change accepted.
+  #define INPUT_FILTER_GLITCH 1   // Pins went back to the accepted state before a change was accepted.
+  #define INPUT_FILTER_CHANGED 2  // A change held for INPUT_FILTER_SAMPLES samples and is now accepted.
+
+  // Input filter state. Works on raw pin states, so a release is filtered like a trigger.
+  typedef struct {
+    uint8_t stable;   // Accepted pin state.
+    uint8_t sample;   // Last sampled pin state, when it differs from the accepted one.
+    uint8_t count;    // Consecutive samples agreeing with sample.
+    uint8_t elapsed;  // Samples since the pins first differed from the accepted state.
+    uint8_t latency;  // Samples the last accepted change took.
+  } input_filter_t;
+
+  // Feeds one pin sample through the filter. A change is accepted only after INPUT_FILTER_SAMPLES
+  // consecutive agreeing samples. A return to the accepted state restarts the count, so two short
+  // bursts split by a single clean sample are rejected as two glitches rather than added together.
+  static inline uint8_t input_filter_update(input_filter_t *filter, uint8_t pin)
+  {
+    if (pin == filter->stable) {
+      if (!filter->elapsed) { return(INPUT_FILTER_IDLE); }
+      filter->elapsed = 0;
+      filter->sample = pin;
+      filter->count = 0;
+      return(INPUT_FILTER_GLITCH);
+    }
+    if (filter->elapsed < 255) { filter->elapsed++; }
+    if (pin != filter->sample) {
+      filter->sample = pin;
+      filter->count = 0;
+    }
+    if (++filter->count < INPUT_FILTER_SAMPLES) { return(INPUT_FILTER_IDLE); }
+    filter->stable = pin;
+    filter->latency = filter->elapsed;
+    filter->elapsed = 0;
+    filter->count = 0;
+    return(INPUT_FILTER_CHANGED);
+  }
+#endif
+
 // Perform one portion of the homing cycle based on the input settings.
 void limits_go_home(uint8_t cycle_mask);
 
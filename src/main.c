@@ -25,60 +25,223 @@
 // Declare system global variable structure
 system_t sys;
 int32_t sys_position[N_AXIS];      // Real-time machine (aka home) position vector in steps.
+volatile int32_t sys_thc_offset;   // THC Z correction in steps, additive to sys_position[Z_AXIS].
 int32_t sys_probe_position[N_AXIS]; // Last probe position in machine coordinates and steps.
+int32_t sys_probe_seek_position[N_AXIS]; // Seek trigger position of the last two-stage probe, in steps.
 volatile uint8_t sys_probe_state;   // Probing state value.  Used to coordinate the probing cycle with stepper ISR.
 volatile uint8_t sys_rt_exec_state;   // Global realtime executor bitflag variable for state management. See EXEC bitmasks.
 volatile uint8_t sys_rt_exec_alarm;   // Global realtime executor bitflag variable for setting various alarms.
 volatile uint8_t sys_rt_exec_motion_override; // Global realtime executor bitflag variable for motion-based overrides.
 volatile uint8_t sys_rt_exec_accessory_override; // Global realtime executor bitflag variable for spindle/coolant overrides.
+volatile uint8_t sys_rt_feed_ovr_set;    // Feed override set by CMD_FEED_OVR_SET. Zero if none pending.
+volatile uint8_t sys_rt_rapid_ovr_set;   // Rapid override set by CMD_RAPID_OVR_SET. Zero if none pending.
+volatile uint8_t sys_rt_spindle_ovr_set; // Spindle override set by CMD_SPINDLE_OVR_SET. Zero if none pending.
+volatile uint8_t sys_rt_exec_thc; // Global realtime executor bitflag variable for THC events.
+volatile buffer_stats_t sys_buffer_stats; // Buffer fill statistics. See system_clear_buffer_stats().
 #ifdef DEBUG
   volatile uint8_t sys_rt_exec_debug;
 #endif
-volatile unsigned long micros;
-volatile unsigned long millis;
-unsigned long millis_timer;
 
-unsigned long z_step_timer;
-unsigned long arc_stablization_timer;
-volatile int z_step_delay;
+volatile uint32_t millis;      // Milliseconds since reset, counted by the Timer2 ISR.
+volatile uint16_t millis_remainder; // Microseconds since millis last incremented.
+
+uint16_t thc_arc_delay_timer; // Arc stabilization countdown in ms. THC corrects once it reaches zero.
+
+// THC Z ramp. Velocity is in steps per Timer2 tick as 0.16 fixed-point and accumulates into the
+// step phase every tick, so a step is due each time the phase wraps. Acceleration is added to or
+// removed from the velocity every tick, giving a trapezoidal profile without any division.
+uint16_t thc_z_max_velocity; // Set from settings by thc_init()
+uint16_t thc_z_acceleration; // Set from settings by thc_init()
+uint16_t thc_z_velocity;
+uint16_t thc_z_phase;
+int8_t thc_z_dir;
+int8_t thc_z_request;  // Direction requested by thc_update(). Applied only while in motion.
+bool thc_z_to_offset;  // Steps of the current ramp go to the THC offset. Latched at ramp start.
+
+// Z step window. Steps that would leave the Z soft limits, or move the THC offset past the max
+// excursion, are dropped and the ramp is stopped. Precomputed in steps by thc_init().
+int32_t thc_z_min_steps;
+int32_t thc_z_max_steps;
+int32_t thc_offset_max_steps;
+volatile bool thc_z_clamped; // Set upon a clamp. Cleared at torch on. Reported in status.
 
 // Value to store analog result
 volatile uint16_t analogVal;
 volatile uint16_t analogSetVal;
 
+// Arc voltage sample mode. Accumulates the ADC over the sample window once the arc has
+// stabilized, then locks the average in as the setpoint until the arc is lost.
+uint32_t thc_sample_sum;
+uint16_t thc_sample_count;
+bool thc_sample_locked;
+
+// Kerf crossing detection. Crossing a kerf or void makes the arc voltage jump for a few ms. A fast
+// slope on the filtered arc voltage holds Z until the voltage is back in band or the hold time is up.
+uint16_t thc_filtered;      // Arc voltage low-pass filter. ADC counts x4.
+uint16_t thc_kerf_timer;    // Remaining kerf hold time in ms. Zero when not holding.
+volatile uint16_t thc_kerf_hold_count; // Number of kerf holds since reset. Reported in status.
+
+// Arc loss detection. Armed once ARC_OK is seen with the torch on. A dropout longer than the
+// debounce time issues a feed hold, so the machine doesn't run the rest of the cut with no arc.
+bool thc_arc_established;
+uint16_t thc_arc_lost_timer; // Length of the current ARC_OK dropout in ms.
+
+// Per-cut telemetry. Arc fields are updated by the Timer2 ISR while a cut is open.
+thc_cut_t thc_cut;
+bool thc_cut_active;
+
+#ifdef ENABLE_THC_CAPTURE
+  // Single producer (Timer2 ISR), single consumer (status report) ring buffer. Indices are
+  // uint8_t, so reads and writes of each are atomic without disabling interrupts.
+  static thc_capture_t thc_capture_buffer[THC_CAPTURE_BUFFER_SIZE];
+  static volatile uint8_t thc_capture_head;
+  static volatile uint8_t thc_capture_tail;
+  static volatile uint8_t thc_capture_dropped;
+  static uint8_t thc_capture_count;   // Decimation counter. Timer2 ISR only.
+  static int16_t thc_capture_z_steps; // Net THC steps since the last record. Timer2 ISR only.
+
+  // Appends a record to the capture buffer. Called from the THC update in the Timer2 ISR.
+  static void thc_capture_update()
+  {
+    if (++thc_capture_count < THC_CAPTURE_DECIMATION) { return; }
+    thc_capture_count = 0;
+
+    uint8_t next_head = thc_capture_head + 1;
+    if (next_head == THC_CAPTURE_BUFFER_SIZE) { next_head = 0; }
+    if (next_head == thc_capture_tail) {
+      // Buffer full. Drop the record, but keep the step tally so the next record accounts for it.
+      if (thc_capture_dropped < 255) { thc_capture_dropped++; }
+      return;
+    }
+
+    thc_capture_t *record = &thc_capture_buffer[thc_capture_head];
+    record->time = (uint16_t)millis;
+    record->adc = analogVal;
+    if (!(PINC & (1<<PC1))) { record->adc |= (1<<THC_CAPTURE_ARC_OK_BIT); }
+    if (thc_capture_z_steps > 127) { record->z_steps = 127; }
+    else if (thc_capture_z_steps < -127) { record->z_steps = -127; }
+    else { record->z_steps = thc_capture_z_steps; }
+    thc_capture_z_steps = 0;
+    // NOTE: The realtime rate is updated by the main program and may be torn by this read. The
+    // worst case is a single noisy sample, which is acceptable for a tuning trace.
+    record->feed = (uint16_t)st_get_realtime_rate();
+    thc_capture_head = next_head;
+  }
+
+  uint8_t thc_capture_read(thc_capture_t *record)
+  {
+    uint8_t tail = thc_capture_tail;
+    if (tail == thc_capture_head) { return(false); }
+    memcpy(record,&thc_capture_buffer[tail],sizeof(thc_capture_t));
+    tail++;
+    if (tail == THC_CAPTURE_BUFFER_SIZE) { tail = 0; }
+    thc_capture_tail = tail;
+    return(true);
+  }
+
+  uint8_t thc_capture_get_dropped()
+  {
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t dropped = thc_capture_dropped;
+    thc_capture_dropped = 0;
+    SREG = sreg;
+    return(dropped);
+  }
+#endif
+
 void thc_update()
 {
   if(PINC & (1<<PC1))
   {
     //We don't have an arc_ok signal
-    jog_z_up = false;
-    jog_z_down = false;
-    arc_stablization_timer = millis;
+    thc_z_request = 0;
+    thc_filtered = analogVal << 2;
+    thc_kerf_timer = 0;
+    thc_sample_sum = 0;
+    thc_sample_count = 0;
+    thc_sample_locked = false;
+    if (thc_arc_established && settings.thc_arc_lost_time)
+    {
+      if (spindle_get_state() == SPINDLE_STATE_DISABLE) //Torch was turned off, the arc is meant to be gone
+      {
+        thc_arc_established = false;
+      }
+      else if (++thc_arc_lost_timer >= settings.thc_arc_lost_time) //Arc lost mid-cut, stop the machine
+      {
+        thc_arc_established = false;
+        system_set_exec_state_flag(EXEC_FEED_HOLD);
+        sys_rt_exec_thc |= EXEC_THC_ARC_LOST;
+      }
+    }
   }
   else
   {
     //We have an arc_ok signal!
+    thc_arc_established = true;
+    thc_arc_lost_timer = 0;
     //Out ADC input is 2:1 voltage divider so pre-divider is 0-10V and post divider is 0-5V. ADC resolution is 0-1024; Each ADC tick is 0.488 Volts pre-divider (AV+) at 1:50th scale!
     //or 0.009 volts at scaled scale (0-10)
-    //Wait 3 secends for arc voltage to stabalize
-    if ((millis - arc_stablization_timer) > 3000)
+    //Filter the arc voltage and find its slope in ADC counts per ms, x4
+    uint16_t last_filtered = thc_filtered;
+    thc_filtered += analogVal - (thc_filtered >> 2);
+    int16_t slope = thc_filtered - last_filtered;
+    //Wait for arc voltage to stabalize. The delay counts down in the tick ISR
+    if (thc_arc_delay_timer == 0)
     {
-      if (analogSetVal > 30) //THC is turned on
+      if (thc_cut_active) //Arc voltage statistics for the per-cut report
+      {
+        uint16_t voltage = thc_filtered >> 2;
+        thc_cut.adc_sum += voltage;
+        thc_cut.adc_count++;
+        if (voltage < thc_cut.adc_min) thc_cut.adc_min = voltage;
+        if (voltage > thc_cut.adc_max) thc_cut.adc_max = voltage;
+      }
+      if (settings.thc_sample_time && !thc_sample_locked) //Sample mode, average the arc voltage to find our setpoint
+      {
+        thc_sample_sum += analogVal;
+        thc_sample_count++;
+        if (thc_sample_count >= settings.thc_sample_time)
+        {
+          analogSetVal = thc_sample_sum / thc_sample_count;
+          thc_sample_locked = true;
+          sys_rt_exec_thc |= EXEC_THC_SAMPLE_DONE; //Report the sampled setpoint from the main program
+        }
+      }
+      else if (analogSetVal > settings.thc_enable_threshold) //THC is turned on
       {
-        if ((analogVal > (analogSetVal - 10)) && (analogVal < (analogSetVal + 10))) //We are within our ok range
+        bool in_band = (analogVal > (analogSetVal - settings.thc_deadband)) && (analogVal < (analogSetVal + settings.thc_deadband));
+        if (thc_kerf_timer) //Holding through a kerf crossing until we are back in range or the hold time is up
+        {
+          if (in_band) thc_kerf_timer = 0;
+          else thc_kerf_timer--;
+        }
+        else if (settings.thc_kerf_slope && (abs(slope) > (settings.thc_kerf_slope << 2))) //Arc voltage is jumping, likely a kerf or void
+        {
+          thc_kerf_timer = settings.thc_kerf_hold_time;
+          thc_kerf_hold_count++;
+        }
+
+        if (st_thc_lock || thc_kerf_timer) //Slowing into a corner, below cut speed or crossing a kerf, hold Z so we don't dive into the part
+        {
+          thc_z_request = 0;
+        }
+        else if (in_band) //We are within our ok range
         {
-          jog_z_up = false;
-          jog_z_down = false;
+          thc_z_request = 0;
+          thc_cut.deadband_time++;
         }
         else //We are not in range and need to deterimine direction needed to put us in range
         {
           if (analogVal > analogSetVal) //Torch is too high
           {
-            jog_z_down = true;
+            if (thc_z_request != -1) thc_cut.down_count++;
+            thc_z_request = -1;
           }
           else //Torch is too low
           {
-            jog_z_up = true;
+            if (thc_z_request != 1) thc_cut.up_count++;
+            thc_z_request = 1;
           }
         }
       }
@@ -86,9 +249,68 @@ void thc_update()
   }
 }
 
-unsigned long cycle_frequency_from_feedrate(double feedrate)
+void thc_cut_begin()
 {
-  return ((1000.0f * 1000.0f) / (settings.steps_per_mm[Z_AXIS])) / feedrate;
+  if (thc_cut_active) { return; } // Spindle speed change mid-cut. Keep the open record.
+  uint8_t sreg = SREG;
+  cli();
+  memset(&thc_cut,0,sizeof(thc_cut_t));
+  thc_cut.adc_min = 0xFFFF;
+  thc_cut_active = true;
+  thc_z_clamped = false;
+  SREG = sreg;
+}
+
+uint8_t thc_cut_end(thc_cut_t *cut)
+{
+  uint8_t sreg = SREG;
+  cli();
+  uint8_t active = thc_cut_active;
+  thc_cut_active = false;
+  memcpy(cut,&thc_cut,sizeof(thc_cut_t));
+  cut->offset = sys_thc_offset;
+  SREG = sreg;
+  if (cut->adc_count == 0) { cut->adc_min = 0; }
+  if (active) { journal_add_cut(cut->arc_time); }
+  return(active);
+}
+
+void thc_init()
+{
+  //Convert max rate (mm/min) and acceleration (mm/sec^2) to fixed-point steps per tick and per tick^2
+  float steps_per_tick = settings.steps_per_mm[Z_AXIS] * (THC_TICK_US / 1000000.0f) * 65536.0f;
+  float velocity = (settings.thc_z_rate / 60.0f) * steps_per_tick;
+  float acceleration = settings.thc_z_accel * (THC_TICK_US / 1000000.0f) * steps_per_tick;
+  if (velocity > 65535.0f) velocity = 65535.0f; //One step a tick is as fast as we can go
+  if (velocity < 1.0f) velocity = 1.0f;
+  if (acceleration > velocity) acceleration = velocity;
+  if (acceleration < 1.0f) acceleration = 1.0f;
+
+  //Z step window from the soft limits. max_travel is stored as negative
+  int32_t min_steps = INT32_MIN;
+  int32_t max_steps = INT32_MAX;
+  if (bit_istrue(settings.flags,BITFLAG_SOFT_LIMIT_ENABLE))
+  {
+    int32_t travel_steps = lround(settings.max_travel[Z_AXIS]*settings.steps_per_mm[Z_AXIS]);
+    #ifdef HOMING_FORCE_SET_ORIGIN
+      if (bit_istrue(settings.homing_dir_mask,bit(Z_AXIS))) { min_steps = 0; max_steps = -travel_steps; }
+      else { min_steps = travel_steps; max_steps = 0; }
+    #else
+      min_steps = travel_steps;
+      max_steps = 0;
+    #endif
+  }
+  int32_t offset_steps = INT32_MAX;
+  if (settings.thc_max_excursion > 0.0f) offset_steps = lround(settings.thc_max_excursion*settings.steps_per_mm[Z_AXIS]);
+
+  uint8_t sreg = SREG;
+  cli();
+  thc_z_max_velocity = velocity;
+  thc_z_acceleration = acceleration;
+  thc_z_min_steps = min_steps;
+  thc_z_max_steps = max_steps;
+  thc_offset_max_steps = offset_steps;
+  SREG = sreg;
 }
 ISR(ADC_vect){
   // Must read low first
@@ -97,11 +319,60 @@ ISR(ADC_vect){
   // Set ADSC in ADCSRA (0x7A) to start another ADC conversion
   // ADCSRA |= B01000000;
 }
-//Fires every 1/8 of a ms, 125uS
-ISR(TIMER2_OVF_vect){
-  if ((micros - z_step_timer) > z_step_delay)
+//Fires every THC_TICK_US, 125 or 128uS
+//Step Z from the tick ISR. Timer2 doesn't nest, so neither the stepper ISR nor its pulse reset can
+//cut this pulse short, and the pin is only ever returned to idle from a pulse we started here.
+static void thc_z_step_pulse()
+{
+  PORTD ^= (1 << PD4);
+  _delay_us(THC_Z_STEP_PULSE_US);
+  PORTD ^= (1 << PD4);
+}
+
+ISR(THC_TICK_vect){
+  #ifdef ENABLE_INPUT_FILTER
+    limits_filter_tick();
+  #endif
+
+  //Ramp the Z velocity towards the requested direction. A reversal decelerates to a stop first.
+  //Manual Z jogs take priority over the THC, which only runs while the machine is in motion.
+  int8_t z_request = 0;
+  if (jog_z_up) z_request = 1;
+  else if (jog_z_down) z_request = -1;
+  else if (machine_in_motion == true) z_request = thc_z_request;
+  else thc_z_request = 0;
+  if (z_request && ((z_request == thc_z_dir) || (thc_z_velocity == 0)))
   {
-    if (jog_z_up)
+    //Corrections made during a cut go to the THC offset and are unwound at torch off. Moves made
+    //while stopped are real moves, so they go to the machine position and the planner is synced.
+    if (thc_z_velocity == 0) thc_z_to_offset = machine_in_motion;
+    thc_z_dir = z_request;
+    if (thc_z_velocity < (thc_z_max_velocity - thc_z_acceleration)) thc_z_velocity += thc_z_acceleration;
+    else thc_z_velocity = thc_z_max_velocity;
+  }
+  else if (thc_z_velocity > thc_z_acceleration) thc_z_velocity -= thc_z_acceleration;
+  else thc_z_velocity = 0;
+
+  uint16_t last_phase = thc_z_phase;
+  thc_z_phase += thc_z_velocity;
+  if (thc_z_phase < last_phase) //Phase wrapped, a step is due
+  {
+    //Keep Z inside the step window. Drop the step and stop dead rather than crash the torch
+    int32_t z_next = sys_position[Z_AXIS] + sys_thc_offset + thc_z_dir;
+    int32_t offset_next = sys_thc_offset + thc_z_dir;
+    if ((z_next < thc_z_min_steps) || (z_next > thc_z_max_steps) ||
+        (thc_z_to_offset && ((offset_next > thc_offset_max_steps) || (offset_next < -thc_offset_max_steps))))
+    {
+      thc_z_velocity = 0;
+      thc_z_phase = 0;
+      if (!thc_z_clamped) sys_rt_exec_thc |= EXEC_THC_CLAMPED; //Report once per cut
+      thc_z_clamped = true;
+    }
+    else if ((PORTD ^ ((settings.step_invert_mask & bit(Z_AXIS)) ? (1 << PD4) : 0)) & (1 << PD4))
+    {
+      thc_z_phase = last_phase; //A planner Z step pulse is still out. Hold the phase and step next tick
+    }
+    else if (thc_z_dir > 0)
     {
       //Dir
       if (settings.dir_invert_mask & (1 << 2)) //Z dir is inverted
@@ -113,12 +384,21 @@ ISR(TIMER2_OVF_vect){
         PORTD &= ~(1 << PD7);    // set pin 7 low
       }
       //Step
-      PORTD |= (1 << PD4);     // set pin A2 high
-      _delay_us(10);
-      PORTD &= ~(1 << PD4);    // set pin A2 low
-      sys_position[Z_AXIS]++;
+      thc_z_step_pulse();
+      if (thc_z_to_offset)
+      {
+        sys_thc_offset++;
+        #ifdef ENABLE_THC_CAPTURE
+          thc_capture_z_steps++;
+        #endif
+      }
+      else
+      {
+        sys_position[Z_AXIS]++;
+        sys_rt_exec_thc |= EXEC_THC_SYNC_POSITION;
+      }
     }
-    else if (jog_z_down)
+    else
     {
       if (settings.dir_invert_mask & (1 << 2)) //Z dir is inverted
       {
@@ -130,31 +410,46 @@ ISR(TIMER2_OVF_vect){
         PORTD |= (1 << PD7);     // set pin A2 high
       }
       //Step
-      PORTD |= (1 << PD4);     // set pin A2 high
-      _delay_us(10);
-      PORTD &= ~(1 << PD4);    // set pin A2 low
-      sys_position[Z_AXIS]--;
+      thc_z_step_pulse();
+      if (thc_z_to_offset)
+      {
+        sys_thc_offset--;
+        #ifdef ENABLE_THC_CAPTURE
+          thc_capture_z_steps--;
+        #endif
+      }
+      else
+      {
+        sys_position[Z_AXIS]--;
+        sys_rt_exec_thc |= EXEC_THC_SYNC_POSITION;
+      }
     }
-    z_step_timer = micros;
   }
 
   //Timing critical
-  if (millis_timer > 7) //8 cycles is one millisecond
+  millis_remainder += THC_TICK_US;
+  if (millis_remainder >= 1000) //Once a millisecond
   {
-    if (machine_in_motion == true) thc_update(); //Once a millisecond, evaluate what the THC should be doing
-    millis_timer = 0;
+    millis_remainder -= 1000;
+    if (thc_cut_active && !(PINC & (1<<PC1))) thc_cut.arc_time++; //Arc-on time, including pierces
+    //Arc delay counts from ARC_OK whether or not we are moving, so a pierce dwell counts towards it
+    if (PINC & (1<<PC1)) thc_arc_delay_timer = settings.thc_arc_delay;
+    else if (thc_arc_delay_timer) thc_arc_delay_timer--;
+    if (machine_in_motion == true)
+    {
+      thc_update(); //Once a millisecond, evaluate what the THC should be doing
+      #ifdef ENABLE_THC_CAPTURE
+        thc_capture_update();
+      #endif
+    }
     millis++;
   }
-  TCNT2 = 223;           //Reset Timer to 130 out of 255
-  TIFR2 = 0x00;          //Timer2 INT Flag Reg: Clear Timer Overflow Flag
-  micros += 125;
-  millis_timer++;
 }
 
 
 int main(void)
 {
-  arc_stablization_timer = 0;
+  thc_arc_delay_timer = 0;
   /* Begin ADC Setup */
   // clear ADLAR in ADMUX (0x7C) to right-adjust the result
   // ADCL will contain lower 8 bits, ADCH upper 2 (in last two bits)
@@ -194,19 +489,31 @@ int main(void)
   ADCSRA |=0b01000000;
   /* End ADC Setup */
 
-  //Setup Timer2 to fire every 1ms
-  TCCR2B = 0x00;        //Disbale Timer2 while we set it up
-  TCNT2  = 130;         //Reset Timer Count to 130 out of 255
-  TIFR2  = 0x00;        //Timer2 INT Flag Reg: Clear Timer Overflow Flag
-  TIMSK2 = 0x01;        //Timer2 INT Reg: Timer2 Overflow Interrupt Enable
-  TCCR2A = 0x00;        //Timer2 Control Reg A: Wave Gen Mode normal
-  TCCR2B = 0x05;        //Timer2 Control Reg B: Timer Prescaler set to 128
-  micros = 0;
+  //Setup Timer2 for the THC tick, every THC_TICK_US
+  TCCR2B = 0x00;        //Disable Timer2 while we set it up
+  TCNT2  = 0;
+  #ifdef VARIABLE_SPINDLE
+    TCCR2A = SPINDLE_TCCRA_INIT_MASK; //Fast PWM, as spindle_init() sets it. The overflow is the tick
+    TIMSK2 = (1<<TOIE2);
+  #else
+    TCCR2A = (1<<WGM21);  //CTC mode, the compare match is the tick
+    OCR2A = (THC_TICK_US*TICKS_PER_MICROSECOND/8)-1;
+    TIMSK2 = (1<<OCIE2A);
+  #endif
+  TIFR2  = (1<<OCF2B)|(1<<OCF2A)|(1<<TOV2); //Clear pending flags
+  TCCR2B = (1<<CS21);   //1/8 prescaler
   millis = 0;
-  millis_timer = 0;
+  millis_remainder = 0;
 
-  z_step_timer = 0;
-  z_step_delay = 0;
+  thc_z_velocity = 0;
+  thc_z_phase = 0;
+  thc_z_dir = 0;
+  thc_z_request = 0;
+  sys_thc_offset = 0;
+  thc_arc_established = false;
+  thc_arc_lost_timer = 0;
+  thc_cut_active = false;
+  thc_z_clamped = false;
 
   
   DDRC &= ~(1<<DDC1); // Set A1 as input for Arc Ok
@@ -225,7 +532,11 @@ int main(void)
 
 
   memset(sys_position,0,sizeof(sys_position)); // Clear machine position.
+  #ifdef JOURNAL_RESTORE_POSITION
+    memcpy(sys_position,journal.position,sizeof(sys_position)); // Zero if the journal is empty.
+  #endif
   sei(); // Enable interrupts
+  uint8_t power_up = true;
 
   // Initialize system state.
   #ifdef FORCE_INITIALIZATION_ALARM
@@ -258,11 +569,22 @@ int main(void)
     sys.r_override = DEFAULT_RAPID_OVERRIDE; // Set to 100%
     sys.spindle_speed_ovr = DEFAULT_SPINDLE_SPEED_OVERRIDE; // Set to 100%
 		memset(sys_probe_position,0,sizeof(sys_probe_position)); // Clear probe position.
+    memset(sys_probe_seek_position,0,sizeof(sys_probe_seek_position));
+    #ifdef ENABLE_CONTINUOUS_JOG
+      jog_continuous = 0;
+      jog_continuous_active = 0;
+    #endif
     sys_probe_state = 0;
     sys_rt_exec_state = 0;
     sys_rt_exec_alarm = 0;
     sys_rt_exec_motion_override = 0;
     sys_rt_exec_accessory_override = 0;
+    sys_rt_feed_ovr_set = 0;
+    sys_rt_rapid_ovr_set = 0;
+    sys_rt_spindle_ovr_set = 0;
+    sys_rt_exec_thc = 0;
+    thc_kerf_hold_count = 0;
+    system_clear_buffer_stats();
 
     // Reset Grbl primary systems.
     serial_reset_read_buffer(); // Clear serial read buffer
@@ -274,6 +596,13 @@ int main(void)
     plan_reset(); // Clear block buffer and planner variables
     st_reset(); // Clear stepper subsystem variables.
 
+    // Fold any THC offset left by an aborted cut into the machine position, so the synced
+    // planner and g-code positions match where the torch actually is.
+    cli();
+    sys_position[Z_AXIS] += sys_thc_offset;
+    sys_thc_offset = 0;
+    sei();
+
     // Sync cleared gcode and planner positions to current system position.
     plan_sync_position();
     gc_sync_position();
@@ -284,7 +613,14 @@ int main(void)
     // Start Grbl main loop. Processes program inputs and executes them.
     
     PORTB &= ~(1 << PB0); //Set torch pin off
-    z_step_delay = cycle_frequency_from_feedrate((12.0f / 60.0f));
+    analogSetVal = settings.thc_target;
+    // At power-up, the last setpoint in the journal takes precedence over $40. Report when it differs.
+    if (power_up && journal.thc_setpoint) {
+      analogSetVal = journal.thc_setpoint;
+      if (analogSetVal != settings.thc_target) { report_feedback_message(MESSAGE_THC_SETPOINT_RESTORED); }
+    }
+    power_up = false;
+    thc_init();
     protocol_main_loop();
 
   }
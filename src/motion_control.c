@@ -253,6 +253,22 @@ void mc_homing_cycle(uint8_t cycle_mask)
 
 // Perform tool length probe cycle. Requires probe switch.
 // NOTE: Upon probe failure, the program will be stopped and placed into ALARM state.
+// Queues a motion, starts the cycle and waits for it to come to rest. With probe_state set to
+// PROBE_ACTIVE, the stepper ISR ends the motion at the probe trigger and captures the position in
+// sys_probe_position. Returns true upon a system abort.
+static uint8_t mc_probe_motion(float *target, plan_line_data_t *pl_data, uint8_t probe_state)
+{
+  mc_line(target, pl_data);
+  sys_probe_state = probe_state;
+  system_set_exec_state_flag(EXEC_CYCLE_START);
+  do {
+    protocol_execute_realtime();
+    if (sys.abort) { return(true); } // Check for system abort
+  } while (sys.state != STATE_IDLE);
+  return(false);
+}
+
+
 uint8_t mc_probe_cycle(float *target, plan_line_data_t *pl_data, uint8_t parser_flags)
 {
   // TODO: Need to update this cycle so it obeys a non-auto cycle start.
@@ -277,18 +293,56 @@ uint8_t mc_probe_cycle(float *target, plan_line_data_t *pl_data, uint8_t parser_
     return(GC_PROBE_FAIL_INIT); // Nothing else to do but bail.
   }
 
-  // Setup and queue probing motion. Auto cycle-start should not start the cycle.
-  mc_line(target, pl_data);
-
-  // Activate the probing state monitor in the stepper module.
-  sys_probe_state = PROBE_ACTIVE;
+  // Two-stage probing, when $55 is set. The programmed rate is the fast seek. Upon the trigger, retract
+  // by $55 toward the start and re-probe at the $56 rate. The result is the slow trigger position.
+  uint8_t is_two_stage = ((settings.probe_retract > 0.0) && (settings.probe_feed_rate > 0.0));
+  float position[N_AXIS];
+  system_convert_array_steps_to_mpos(position, sys_position); // Start position
+
+  // Setup and queue probing motion and activate the probing state monitor in the stepper module.
+  // Wait here until probe is triggered or motion completes.
+  if (mc_probe_motion(target, pl_data, PROBE_ACTIVE)) { return(GC_PROBE_ABORT); }
+
+  if (is_two_stage && (sys_probe_state == PROBE_OFF)) {
+    // Seek triggered. Keep its position and discard the remainder of the seek motion.
+    memcpy(sys_probe_seek_position, sys_probe_position, sizeof(sys_probe_position));
+    st_reset();
+    plan_reset();
+    plan_sync_position();
+
+    // Retract from the trigger position toward the start, but no farther than the seek travelled.
+    float retract[N_AXIS];
+    float distance = 0.0;
+    uint8_t idx;
+    for (idx=0; idx<N_AXIS; idx++) {
+      retract[idx] = position[idx];
+      position[idx] = system_convert_axis_steps_to_mpos(sys_probe_position, idx);
+      distance += (retract[idx]-position[idx])*(retract[idx]-position[idx]);
+    }
+    distance = sqrt(distance);
+    if (distance > settings.probe_retract) {
+      distance = settings.probe_retract/distance;
+      for (idx=0; idx<N_AXIS; idx++) { retract[idx] = position[idx]+distance*(retract[idx]-position[idx]); }
+    }
+    pl_data->condition &= ~PL_COND_FLAG_INVERSE_TIME;
+    pl_data->condition |= PL_COND_FLAG_RAPID_MOTION;
+    if (mc_probe_motion(retract, pl_data, PROBE_OFF)) { return(GC_PROBE_ABORT); }
+
+    // The probe must have released in the retract. If not, alarm as for an initially triggered probe.
+    if ( probe_get_state() ) {
+      system_set_exec_alarm(EXEC_ALARM_PROBE_FAIL_INITIAL);
+      protocol_execute_realtime();
+      probe_configure_invert_mask(false);
+      return(GC_PROBE_FAIL_INIT);
+    }
 
-  // Perform probing cycle. Wait here until probe is triggered or motion completes.
-  system_set_exec_state_flag(EXEC_CYCLE_START);
-  do {
-    protocol_execute_realtime();
-    if (sys.abort) { return(GC_PROBE_ABORT); } // Check for system abort
-  } while (sys.state != STATE_IDLE);
+    // Slow re-probe toward the original target.
+    pl_data->condition &= ~PL_COND_FLAG_RAPID_MOTION;
+    pl_data->feed_rate = settings.probe_feed_rate;
+    if (mc_probe_motion(target, pl_data, PROBE_ACTIVE)) { return(GC_PROBE_ABORT); }
+  } else {
+    is_two_stage = false; // Single stage, or the seek did not trigger.
+  }
 
   // Probing cycle complete!
 
@@ -299,6 +353,7 @@ uint8_t mc_probe_cycle(float *target, plan_line_data_t *pl_data, uint8_t parser_
   } else {
     sys.probe_succeeded = true; // Indicate to system the probing cycle completed successfully.
   }
+  if (!is_two_stage) { memcpy(sys_probe_seek_position, sys_probe_position, sizeof(sys_probe_position)); }
   sys_probe_state = PROBE_OFF; // Ensure probe state monitor is disabled.
   probe_configure_invert_mask(false); // Re-initialize invert mask.
   protocol_execute_realtime();   // Check and execute run-time commands
@@ -358,6 +413,46 @@ uint8_t mc_probe_cycle(float *target, plan_line_data_t *pl_data, uint8_t parser_
 #endif
 
 
+// Removes the THC Z offset after a cut. THC corrections are kept out of the machine position in
+// sys_thc_offset, so the planner and g-code parser positions stay valid through the cut. Here the
+// offset is folded into the machine position and the planner is synced to where the torch actually
+// is. If the THC drove the torch below the programmed height, a rapid back up to it removes the
+// offset as a normal planned, accelerated move. If it raised the torch, as over warped or tented
+// sheet, Z is left where it is rather than driven down at the plate. The parser is synced instead,
+// and gc_execute_line() moves the rest of the torch off block's targets up with it. Called at torch
+// off, once the buffer is synced and the steppers are idle.
+void mc_thc_unwind()
+{
+  if ((sys.state == STATE_CHECK_MODE) || sys.abort) { return; }
+
+  float target[N_AXIS];
+  system_convert_array_steps_to_mpos(target,sys_position);
+
+  uint8_t sreg = SREG;
+  cli();
+  int32_t offset = sys_thc_offset;
+  sys_position[Z_AXIS] += offset;
+  sys_thc_offset = 0;
+  SREG = sreg;
+  if (offset == 0) { return; }
+
+  plan_sync_position();
+  if (offset > 0) { // Torch above the programmed height. Never move down.
+    gc_sync_position();
+    return;
+  }
+  plan_line_data_t plan_data;
+  plan_line_data_t *pl_data = &plan_data;
+  memset(pl_data,0,sizeof(plan_line_data_t)); // Zero pl_data struct
+  pl_data->condition = PL_COND_FLAG_RAPID_MOTION;
+  #ifdef USE_LINE_NUMBERS
+    pl_data->line_number = gc_state.line_number;
+  #endif
+  mc_line(target, pl_data);
+  protocol_buffer_synchronize();
+}
+
+
 // Method to ready the system to reset by setting the realtime reset command and killing any
 // active processes in the system. This also checks if a system reset is issued while Grbl
 // is in a motion state. If so, kills the steppers and sets the system alarm to flag position
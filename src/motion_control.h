@@ -60,6 +60,9 @@ void mc_override_ctrl_update(uint8_t override_state);
 // Plans and executes the single special motion case for parking. Independent of main planner buffer.
 void mc_parking_motion(float *parking_target, plan_line_data_t *pl_data);
 
+// Unwinds the THC Z offset left by a cut with a planned move back to the programmed Z height.
+void mc_thc_unwind();
+
 // Performs system reset. If in motion state, kills all motion and sets system alarm.
 void mc_reset();
 
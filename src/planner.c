@@ -36,6 +36,7 @@ typedef struct {
                                      // i.e. arcs, canned cycles, and backlash compensation.
   float previous_unit_vec[N_AXIS];   // Unit vector of previous path line segment
   float previous_nominal_speed;  // Nominal speed of previous path line segment
+  uint8_t ovr_stale;             // Set upon a motion override change until the blocks are replanned. See plan_refresh_block().
 } planner_t;
 static planner_t pl;
 
@@ -123,6 +124,39 @@ static uint8_t plan_prev_block_index(uint8_t block_index)
   ARM versions should have enough memory and speed for look-ahead blocks numbering up to a hundred or more.
 
 */
+
+// Computes and updates the max entry speed (sqr) of the block, based on the minimum of the junction's
+// previous and current nominal speeds and max junction speed.
+static void plan_compute_profile_parameters(plan_block_t *block, float nominal_speed, float prev_nominal_speed)
+{
+  // Compute the junction maximum entry based on the minimum of the junction speed and neighboring nominal speeds.
+  if (nominal_speed > prev_nominal_speed) { block->max_entry_speed_sqr = prev_nominal_speed*prev_nominal_speed; }
+  else { block->max_entry_speed_sqr = nominal_speed*nominal_speed; }
+  if (block->max_entry_speed_sqr > block->max_junction_speed_sqr) { block->max_entry_speed_sqr = block->max_junction_speed_sqr; }
+}
+
+
+// Re-calculates the max entry speed of a block after a motion override change. Called by the planner
+// reverse pass for each block it replans, so an override change costs no separate pass over the buffer.
+// An override change resets the planned pointer, so the next replan revisits them all, and the blocks
+// are stale until then. A block planned in the meantime is recomputed too, to the same result.
+// The nominal speed of the block is passed in when known, or zero, and the nominal speed of the block
+// before it is returned for its own refresh next in the reverse pass, or zero if not computed. Each
+// stale block nominal speed is then computed once.
+static float plan_refresh_block(uint8_t block_index, float nominal_speed)
+{
+  plan_block_t *block = &block_buffer[block_index];
+  if (!pl.ovr_stale) { return(0.0); }
+  if (nominal_speed == 0.0) { nominal_speed = plan_compute_profile_nominal_speed(block); }
+  float prev_nominal_speed = SOME_LARGE_VALUE; // Tail block. Set high as for the first block in the buffer.
+  if (block_index != block_buffer_tail) {
+    prev_nominal_speed = plan_compute_profile_nominal_speed(&block_buffer[plan_prev_block_index(block_index)]);
+  }
+  plan_compute_profile_parameters(block, nominal_speed, prev_nominal_speed);
+  return(prev_nominal_speed);
+}
+
+
 static void planner_recalculate()
 {
   // Initialize block index to the last block in the planner buffer.
@@ -137,6 +171,8 @@ static void planner_recalculate()
   float entry_speed_sqr;
   plan_block_t *next;
   plan_block_t *current = &block_buffer[block_index];
+  // The last block nominal speed is kept current for the next incoming block. See plan_buffer_line().
+  float nominal_speed = plan_refresh_block(block_index, pl.previous_nominal_speed); // Of the block before, if computed.
 
   // Calculate maximum entry speed for last block in buffer, where the exit speed is always zero.
   current->entry_speed_sqr = min( current->max_entry_speed_sqr, 2*current->acceleration*current->millimeters);
@@ -149,6 +185,7 @@ static void planner_recalculate()
     while (block_index != block_buffer_planned) {
       next = current;
       current = &block_buffer[block_index];
+      nominal_speed = plan_refresh_block(block_index, nominal_speed);
       block_index = plan_prev_block_index(block_index);
 
       // Check if next block is the tail block(=planned block). If so, update current stepper parameters.
@@ -165,6 +202,7 @@ static void planner_recalculate()
       }
     }
   }
+  pl.ovr_stale = false; // All blocks after the executing one are refreshed.
 
   // Forward Pass: Forward plan the acceleration curve from the planned pointer onward.
   // Also scans for optimal plan breakpoints and appropriately updates the planned pointer.
@@ -269,32 +307,19 @@ float plan_compute_profile_nominal_speed(plan_block_t *block)
 }
 
 
-// Computes and updates the max entry speed (sqr) of the block, based on the minimum of the junction's
-// previous and current nominal speeds and max junction speed.
-static void plan_compute_profile_parameters(plan_block_t *block, float nominal_speed, float prev_nominal_speed)
-{
-  // Compute the junction maximum entry based on the minimum of the junction speed and neighboring nominal speeds.
-  if (nominal_speed > prev_nominal_speed) { block->max_entry_speed_sqr = prev_nominal_speed*prev_nominal_speed; }
-  else { block->max_entry_speed_sqr = nominal_speed*nominal_speed; }
-  if (block->max_entry_speed_sqr > block->max_junction_speed_sqr) { block->max_entry_speed_sqr = block->max_junction_speed_sqr; }
-}
-
-
-// Re-calculates buffered motions profile parameters upon a motion-based override change.
+// Marks buffered motions profile parameters stale upon a motion-based override change. Instead of
+// re-calculating every block here, each block is refreshed by plan_refresh_block() when the planner
+// next replans it, and the stepper computes the executing block nominal speed when it prepares it.
+// NOTE: The planned pointer is reset, as blocks behind it were planned to the old limits. An increase
+// leaves them feasible but no longer optimal, and a reduction may leave them above the new limits.
 void plan_update_velocity_profile_parameters()
 {
-  uint8_t block_index = block_buffer_tail;
-  plan_block_t *block;
-  float nominal_speed;
-  float prev_nominal_speed = SOME_LARGE_VALUE; // Set high for first block nominal speed calculation.
-  while (block_index != block_buffer_head) {
-    block = &block_buffer[block_index];
-    nominal_speed = plan_compute_profile_nominal_speed(block);
-    plan_compute_profile_parameters(block, nominal_speed, prev_nominal_speed);
-    prev_nominal_speed = nominal_speed;
-    block_index = plan_next_block_index(block_index);
+  pl.ovr_stale = true;
+  block_buffer_planned = block_buffer_tail;
+  // Update prev nominal speed for next incoming block.
+  if (block_buffer_head != block_buffer_tail) {
+    pl.previous_nominal_speed = plan_compute_profile_nominal_speed(&block_buffer[plan_prev_block_index(block_buffer_head)]);
   }
-  pl.previous_nominal_speed = prev_nominal_speed; // Update prev nominal speed for next incoming block.
 }
 
 
@@ -387,6 +412,7 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
   block->millimeters = convert_delta_vector_to_unit_vector(unit_vec);
   block->acceleration = limit_value_by_axis_maximum(settings.acceleration, unit_vec);
   block->rapid_rate = limit_value_by_axis_maximum(settings.max_rate, unit_vec);
+  if (block->condition & PL_COND_SPINDLE_MASK) { thc_cut.distance += block->millimeters; } // Torch on. Tally cut distance.
 
   // Store programmed rate.
   if (block->condition & PL_COND_FLAG_RAPID_MOTION) { block->programmed_rate = block->rapid_rate; }
@@ -444,9 +470,8 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
       } else {
         convert_delta_vector_to_unit_vector(junction_unit_vec);
         float junction_acceleration = limit_value_by_axis_maximum(settings.acceleration, junction_unit_vec);
-        float sin_theta_d2 = sqrt(0.5*(1.0-junction_cos_theta)); // Trig half angle identity. Always positive.
-        block->max_junction_speed_sqr = max( MINIMUM_JUNCTION_SPEED*MINIMUM_JUNCTION_SPEED,
-                       (junction_acceleration * settings.junction_deviation * sin_theta_d2)/(1.0-sin_theta_d2) );
+        block->max_junction_speed_sqr = plan_compute_junction_speed_sqr(junction_cos_theta, junction_acceleration,
+                                                                        settings.junction_deviation);
       }
     }
   }
@@ -125,7 +125,19 @@ float plan_get_exec_block_exit_speed_sqr();
 // Called by main program during planner calculations and step segment buffer during initialization.
 float plan_compute_profile_nominal_speed(plan_block_t *block);
 
-// Re-calculates buffered motions profile parameters upon a motion-based override change.
+// Computes the junction speed limit (sqr) by the centripetal acceleration approximation, from the cosine
+// of the angle between the previous and current path unit vectors. Called by plan_buffer_line() for all
+// but straight and reversing junctions.
+static inline float plan_compute_junction_speed_sqr(float junction_cos_theta, float junction_acceleration,
+                                                    float junction_deviation)
+{
+  float sin_theta_d2 = sqrt(0.5*(1.0-junction_cos_theta)); // Trig half angle identity. Always positive.
+  return( max( MINIMUM_JUNCTION_SPEED*MINIMUM_JUNCTION_SPEED,
+               (junction_acceleration * junction_deviation * sin_theta_d2)/(1.0-sin_theta_d2) ) );
+}
+
+// Marks the buffered motions profile parameters stale upon a motion-based override change. They are
+// re-calculated lazily, as the planner next replans each block.
 void plan_update_velocity_profile_parameters();
 
 // Reset the planner position vector (in steps)
@@ -79,6 +79,16 @@ void print_uint8_base10(uint8_t n)
 }
 
 
+// Prints an uint8 variable in base 16 as exactly two uppercase digits.
+void print_uint8_base16(uint8_t n)
+{
+  uint8_t digit = n >> 4;
+  serial_write(digit < 10 ? '0' + digit : 'A' + digit - 10);
+  digit = n & 0x0F;
+  serial_write(digit < 10 ? '0' + digit : 'A' + digit - 10);
+}
+
+
 // Prints an uint8 variable in base 2 with desired number of desired digits.
 void print_uint8_base2_ndigit(uint8_t n, uint8_t digits) {
   unsigned char buf[digits];
@@ -34,6 +34,9 @@ void print_uint32_base10(uint32_t n);
 // Prints an uint8 variable in base 10.
 void print_uint8_base10(uint8_t n);
 
+// Prints an uint8 variable in base 16 as exactly two uppercase digits.
+void print_uint8_base16(uint8_t n);
+
 // Prints an uint8 variable in base 2 with desired number of desired digits.
 void print_uint8_base2_ndigit(uint8_t n, uint8_t digits);
 
@@ -30,6 +30,7 @@
 static char line[LINE_BUFFER_SIZE]; // Line to be executed. Zero-terminated.
 
 static void protocol_exec_rt_suspend();
+static uint8_t protocol_thc_repierce();
 
 /* CRC-32C (iSCSI) polynomial in reversed bit order. */
 #define POLY 0x82f63b78
@@ -213,6 +214,10 @@ void protocol_main_loop()
     // completed. In either case, auto-cycle start, if enabled, any queued moves.
     protocol_auto_cycle_start();
 
+    #ifdef ENABLE_CONTINUOUS_JOG
+      jog_continuous_execute(); // Start a continuous jog requested by the realtime jog bytes.
+    #endif
+
     protocol_execute_realtime();  // Runtime command check point.
     if (sys.abort) { return; } // Bail to main() program loop to reset system.
   }
@@ -227,10 +232,12 @@ void protocol_buffer_synchronize()
 {
   // If system is queued, ensure cycle resumes if the auto start flag is present.
   protocol_auto_cycle_start();
+  sys.buffer_sync = true; // The planner is drained on purpose. Not a starvation.
   do {
     protocol_execute_realtime();   // Check and execute run-time commands
-    if (sys.abort) { return; } // Check for system abort
+    if (sys.abort) { return; } // Check for system abort. Flag is cleared by the reset.
   } while (plan_get_current_block() || (sys.state == STATE_CYCLE));
+  sys.buffer_sync = false;
 }
 
 
@@ -272,6 +279,9 @@ void protocol_execute_realtime()
 void protocol_exec_rt_system()
 {
   uint8_t rt_exec; // Temp variable to avoid calling volatile multiple times.
+
+  journal_write(); // Queue the rest of a journal record as the EEPROM write queue drains.
+
   rt_exec = sys_rt_exec_alarm; // Copy volatile sys_rt_exec_alarm.
   if (rt_exec) { // Enter only if any bit flag is true
     // System alarm. Everything has shutdown by something that has gone severely wrong. Report
@@ -461,10 +471,15 @@ void protocol_exec_rt_system()
 
   // Execute overrides.
   rt_exec = sys_rt_exec_motion_override; // Copy volatile sys_rt_exec_motion_override
-  if (rt_exec) {
+  uint8_t ovr_set = system_take_exec_ovr_set(&sys_rt_feed_ovr_set);
+  uint8_t r_ovr_set = system_take_exec_ovr_set(&sys_rt_rapid_ovr_set);
+  if (rt_exec || ovr_set || r_ovr_set) {
     system_clear_exec_motion_overrides(); // Clear all motion override flags.
 
+    // Absolute override sets are applied first. Increments received in the same pass add to them,
+    // so the set value is brought within the limits beforehand, keeping the sum from wrapping.
     uint8_t new_f_override =  sys.f_override;
+    if (ovr_set) { new_f_override = max(min(ovr_set,MAX_FEED_RATE_OVERRIDE),MIN_FEED_RATE_OVERRIDE); }
     if (rt_exec & EXEC_FEED_OVR_RESET) { new_f_override = DEFAULT_FEED_OVERRIDE; }
     if (rt_exec & EXEC_FEED_OVR_COARSE_PLUS) { new_f_override += FEED_OVERRIDE_COARSE_INCREMENT; }
     if (rt_exec & EXEC_FEED_OVR_COARSE_MINUS) { new_f_override -= FEED_OVERRIDE_COARSE_INCREMENT; }
@@ -474,25 +489,36 @@ void protocol_exec_rt_system()
     new_f_override = max(new_f_override,MIN_FEED_RATE_OVERRIDE);
 
     uint8_t new_r_override = sys.r_override;
+    if (r_ovr_set) {
+      new_r_override = min(r_ovr_set,DEFAULT_RAPID_OVERRIDE);
+      new_r_override = max(new_r_override,RAPID_OVERRIDE_LOW);
+    }
     if (rt_exec & EXEC_RAPID_OVR_RESET) { new_r_override = DEFAULT_RAPID_OVERRIDE; }
     if (rt_exec & EXEC_RAPID_OVR_MEDIUM) { new_r_override = RAPID_OVERRIDE_MEDIUM; }
     if (rt_exec & EXEC_RAPID_OVR_LOW) { new_r_override = RAPID_OVERRIDE_LOW; }
 
     if ((new_f_override != sys.f_override) || (new_r_override != sys.r_override)) {
+      // A reduction must replan the buffer now, as the planned speeds may exceed the nominal ones. An
+      // increase leaves the plan feasible, so only the executing block is re-profiled by the stepper.
+      // The rest are replanned to the higher limits when the next line is planned.
+      uint8_t is_reduction = ((new_f_override < sys.f_override) || (new_r_override < sys.r_override));
       sys.f_override = new_f_override;
       sys.r_override = new_r_override;
       sys.report_ovr_counter = 0; // Set to report change immediately
       plan_update_velocity_profile_parameters();
-      plan_cycle_reinitialize();
+      if (is_reduction) { plan_cycle_reinitialize(); }
+      else { st_update_plan_block_parameters(); }
     }
   }
 
   rt_exec = sys_rt_exec_accessory_override;
-  if (rt_exec) {
+  ovr_set = system_take_exec_ovr_set(&sys_rt_spindle_ovr_set);
+  if (rt_exec || ovr_set) {
     system_clear_exec_accessory_overrides(); // Clear all accessory override flags.
 
     // NOTE: Unlike motion overrides, spindle overrides do not require a planner reinitialization.
     uint8_t last_s_override =  sys.spindle_speed_ovr;
+    if (ovr_set) { last_s_override = max(min(ovr_set,MAX_SPINDLE_SPEED_OVERRIDE),MIN_SPINDLE_SPEED_OVERRIDE); }
     if (rt_exec & EXEC_SPINDLE_OVR_RESET) { last_s_override = DEFAULT_SPINDLE_SPEED_OVERRIDE; }
     if (rt_exec & EXEC_SPINDLE_OVR_COARSE_PLUS) { last_s_override += SPINDLE_OVERRIDE_COARSE_INCREMENT; }
     if (rt_exec & EXEC_SPINDLE_OVR_COARSE_MINUS) { last_s_override -= SPINDLE_OVERRIDE_COARSE_INCREMENT; }
@@ -543,6 +569,29 @@ void protocol_exec_rt_system()
     }
   }
 
+  rt_exec = sys_rt_exec_thc;
+  if (rt_exec) {
+    // Z jogs made while stopped move the machine position. Sync once idle, otherwise leave pending.
+    if (sys.state != STATE_IDLE) { rt_exec &= ~(EXEC_THC_SYNC_POSITION); }
+    system_clear_exec_thc_flag(rt_exec);
+    if (rt_exec & EXEC_THC_SAMPLE_DONE) { report_thc_sample(); }
+    if (rt_exec & EXEC_THC_CLAMPED) { report_feedback_message(MESSAGE_THC_CLAMPED); }
+    if (rt_exec & EXEC_THC_ARC_LOST) {
+      report_feedback_message(MESSAGE_ARC_LOST);
+      // Turn the torch off for the hold via the spindle stop override. Cycle start re-pierces.
+      // The feed hold set alongside may not have been executed yet, so arm it while in a cycle too.
+      // The override is only acted upon once the hold completes.
+      if (sys.state & (STATE_CYCLE | STATE_HOLD)) {
+        sys.thc_arc_lost = true;
+        sys.spindle_stop_ovr = SPINDLE_STOP_OVR_INITIATE;
+      }
+    }
+    if (rt_exec & EXEC_THC_SYNC_POSITION) {
+      plan_sync_position();
+      gc_sync_position();
+    }
+  }
+
   #ifdef DEBUG
     if (sys_rt_exec_debug) {
       report_realtime_debug();
@@ -785,7 +834,13 @@ static void protocol_exec_rt_suspend()
             if (gc_state.modal.spindle != SPINDLE_DISABLE) {
               spindle_set_state(SPINDLE_DISABLE,0.0); // De-energize
               sys.spindle_stop_ovr = SPINDLE_STOP_OVR_ENABLED; // Set stop override state to enabled, if de-energized.
+              // Arc loss. Re-pierce and resume automatically, if any retries are left for this cut.
+              if (sys.thc_arc_lost && (sys.thc_repierce_count < settings.thc_repierce_retries)) {
+                sys.thc_repierce_count++;
+                sys.spindle_stop_ovr |= SPINDLE_STOP_OVR_RESTORE_CYCLE;
+              }
             } else {
+              sys.thc_arc_lost = false;
               sys.spindle_stop_ovr = SPINDLE_STOP_OVR_DISABLED; // Clear stop override state
             }
           // Handles restoring of spindle state
@@ -799,10 +854,22 @@ static void protocol_exec_rt_suspend()
                 spindle_set_state((restore_condition & (PL_COND_FLAG_SPINDLE_CW | PL_COND_FLAG_SPINDLE_CCW)), restore_spindle_speed);
               }
             }
-            if (sys.spindle_stop_ovr & SPINDLE_STOP_OVR_RESTORE_CYCLE) {
-              system_set_exec_state_flag(EXEC_CYCLE_START);  // Set to resume program.
+            if (sys.thc_arc_lost && !protocol_thc_repierce()) {
+              // Arc didn't transfer. Torch off and remain in the hold, or try again if retries are left.
+              spindle_set_state(SPINDLE_DISABLE,0.0); // De-energize
+              report_feedback_message(MESSAGE_ARC_LOST);
+              sys.spindle_stop_ovr = SPINDLE_STOP_OVR_ENABLED;
+              if (sys.thc_repierce_count < settings.thc_repierce_retries) {
+                sys.thc_repierce_count++;
+                sys.spindle_stop_ovr |= SPINDLE_STOP_OVR_RESTORE_CYCLE;
+              }
+            } else {
+              sys.thc_arc_lost = false;
+              if (sys.spindle_stop_ovr & SPINDLE_STOP_OVR_RESTORE_CYCLE) {
+                system_set_exec_state_flag(EXEC_CYCLE_START);  // Set to resume program.
+              }
+              sys.spindle_stop_ovr = SPINDLE_STOP_OVR_DISABLED; // Clear stop override state
             }
-            sys.spindle_stop_ovr = SPINDLE_STOP_OVR_DISABLED; // Clear stop override state
           }
         } else {
           // Handles spindle state during hold. NOTE: Spindle speed overrides may be altered during hold state.
@@ -820,3 +887,18 @@ static void protocol_exec_rt_suspend()
 
   }
 }
+
+
+// Waits for the arc to transfer after the torch is re-fired during an arc loss hold, then dwells
+// for the pierce delay. Returns false if ARC_OK doesn't come up in time or the system is aborted.
+static uint8_t protocol_thc_repierce()
+{
+  uint16_t i = ceil(1000/DWELL_TIME_STEP*THC_REPIERCE_ARC_TIMEOUT);
+  while (PINC & (1<<PC1)) { // ARC_OK is active low.
+    if (sys.abort || (i-- == 0)) { return(false); }
+    protocol_exec_rt_system(); // Execute rt_system() only to avoid nesting suspend loops.
+    _delay_ms(DWELL_TIME_STEP);
+  }
+  delay_sec(0.001*settings.thc_pierce_delay, DELAY_MODE_SYS_SUSPEND);
+  return(!sys.abort);
+}
@@ -97,6 +97,11 @@ static void report_util_uint8_setting(uint8_t n, int val) {
   print_uint8_base10(val); 
   report_util_line_feed(); // report_util_setting_string(n); 
 }
+static void report_util_uint16_setting(uint8_t n, uint16_t val) { 
+  report_util_setting_prefix(n); 
+  print_uint32_base10(val); 
+  report_util_line_feed(); // report_util_setting_string(n); 
+}
 static void report_util_float_setting(uint8_t n, float val, uint8_t n_decimal) { 
   report_util_setting_prefix(n); 
   printFloat(val,n_decimal);
@@ -164,11 +169,101 @@ void report_feedback_message(uint8_t message_code)
       printPgmString(PSTR("Restoring spindle")); break;
     case MESSAGE_SLEEP_MODE:
       printPgmString(PSTR("Sleeping")); break;
+    case MESSAGE_ARC_LOST:
+      printPgmString(PSTR("Arc lost")); break;
+    case MESSAGE_THC_CLAMPED:
+      printPgmString(PSTR("THC clamped")); break;
+    case MESSAGE_THC_SETPOINT_RESTORED:
+      printPgmString(PSTR("THC setpoint from journal")); break;
   }
   report_util_feedback_line_feed();
 }
 
 
+// Prints the arc voltage setpoint locked in by the THC sample mode.
+void report_thc_sample()
+{
+  printPgmString(PSTR("[THC:"));
+  print_uint32_base10(analogSetVal);
+  report_util_feedback_line_feed();
+}
+
+
+// Per-cut record. Fields are arc-on time (ms), distance, mean/min/max filtered arc voltage (ADC
+// counts), THC up/down corrections, net THC Z offset and time within the deadband (ms).
+void report_thc_cut()
+{
+  thc_cut_t cut;
+  if (!thc_cut_end(&cut)) { return; }
+  printPgmString(PSTR("[CUT:"));
+  print_uint32_base10(cut.arc_time);
+  serial_write(',');
+  printFloat_CoordValue(cut.distance);
+  serial_write(',');
+  print_uint32_base10(cut.adc_count ? (cut.adc_sum/cut.adc_count) : 0);
+  serial_write(',');
+  print_uint32_base10(cut.adc_min);
+  serial_write(',');
+  print_uint32_base10(cut.adc_max);
+  serial_write(',');
+  print_uint32_base10(cut.up_count);
+  serial_write(',');
+  print_uint32_base10(cut.down_count);
+  serial_write(',');
+  printFloat_CoordValue(cut.offset/settings.steps_per_mm[Z_AXIS]);
+  serial_write(',');
+  print_uint32_base10(cut.deadband_time);
+  report_util_feedback_line_feed();
+}
+
+
+// Prints segment, planner and serial RX buffer fill statistics.
+// [BUF:seg_min,seg_max,plan_min,plan_max,rx_max,underruns,starvations]
+void report_buffer_stats()
+{
+  buffer_stats_t stats;
+  uint8_t sreg = SREG;
+  cli();
+  memcpy(&stats, (void*)&sys_buffer_stats, sizeof(buffer_stats_t));
+  SREG = sreg;
+  if (stats.segment_max == 0) { stats.segment_min = 0; stats.planner_min = 0; } // Not sampled yet.
+  printPgmString(PSTR("[BUF:"));
+  print_uint8_base10(stats.segment_min);
+  serial_write(',');
+  print_uint8_base10(stats.segment_max);
+  serial_write(',');
+  print_uint8_base10(stats.planner_min);
+  serial_write(',');
+  print_uint8_base10(stats.planner_max);
+  serial_write(',');
+  print_uint8_base10(stats.serial_rx_max);
+  serial_write(',');
+  print_uint32_base10(stats.underruns);
+  serial_write(',');
+  print_uint32_base10(stats.starvations);
+  report_util_feedback_line_feed();
+  #ifdef ENABLE_INPUT_FILTER
+    printPgmString(PSTR("[FLT:")); // Limit input filter. [FLT:glitches,max latency in usec]
+    print_uint32_base10(stats.limit_glitches);
+    serial_write(',');
+    print_uint32_base10((uint32_t)stats.limit_latency_max*THC_TICK_US);
+    report_util_feedback_line_feed();
+  #endif
+}
+
+
+#ifdef ENABLE_DUAL_AXIS
+  // Prints the position of the dual motor switch relative to the main one, as latched in the last
+  // locate approach. The $54 squaring offset to compensate is close to this value.
+  void report_homing_dual_skew(float skew)
+  {
+    printPgmString(PSTR("[SKEW:"));
+    printFloat_CoordValue(skew);
+    report_util_feedback_line_feed();
+  }
+#endif
+
+
 // Welcome message
 void report_init_message()
 {
@@ -177,7 +272,7 @@ void report_init_message()
 
 // Grbl help message
 void report_grbl_help() {
-  printPgmString(PSTR("[HLP:$$ $# $G $I $N $x=val $Nx=line $J=line $SLP $C $X $H ~ ! ? ctrl-x]\r\n"));    
+  printPgmString(PSTR("[HLP:$$ $# $G $I $N $x=val $Nx=line $J=line $SLP $T=val $P $P=n $PS=n $B $C $X $H ~ ! ? ctrl-x]\r\n"));    
 }
 
 
@@ -211,6 +306,23 @@ void report_grbl_settings() {
   #else
     report_util_uint8_setting(32,0);
   #endif
+  report_util_uint16_setting(40,settings.thc_target);
+  report_util_uint8_setting(41,settings.thc_deadband);
+  report_util_uint16_setting(42,settings.thc_enable_threshold);
+  report_util_uint16_setting(43,settings.thc_arc_delay);
+  report_util_float_setting(44,settings.thc_z_rate,N_DECIMAL_SETTINGVALUE);
+  report_util_uint16_setting(45,settings.thc_sample_time);
+  report_util_uint8_setting(46,settings.thc_velocity_threshold);
+  report_util_uint8_setting(47,settings.thc_kerf_slope);
+  report_util_uint16_setting(48,settings.thc_kerf_hold_time);
+  report_util_float_setting(49,settings.thc_z_accel,N_DECIMAL_SETTINGVALUE);
+  report_util_uint16_setting(50,settings.thc_arc_lost_time);
+  report_util_uint8_setting(51,settings.thc_repierce_retries);
+  report_util_uint16_setting(52,settings.thc_pierce_delay);
+  report_util_float_setting(53,settings.thc_max_excursion,N_DECIMAL_SETTINGVALUE);
+  report_util_float_setting(54,settings.homing_dual_offset,N_DECIMAL_SETTINGVALUE);
+  report_util_float_setting(55,settings.probe_retract,N_DECIMAL_SETTINGVALUE);
+  report_util_float_setting(56,settings.probe_feed_rate,N_DECIMAL_SETTINGVALUE);
   // Print axis settings
   uint8_t idx, set_idx;
   uint8_t val = AXIS_SETTINGS_START_VAL;
@@ -240,6 +352,12 @@ void report_probe_parameters()
   report_util_axis_values(print_position);
   serial_write(':');
   print_uint8_base10(sys.probe_succeeded);
+  if (settings.probe_retract > 0.0) {
+    // Two-stage probing. Append the seek trigger position, so both come back in the one reply.
+    serial_write(':');
+    system_convert_array_steps_to_mpos(print_position,sys_probe_seek_position);
+    report_util_axis_values(print_position);
+  }
   report_util_feedback_line_feed();
 }
 
@@ -271,6 +389,17 @@ void report_ngc_parameters()
   printFloat_CoordValue(gc_state.tool_length_offset);
   report_util_feedback_line_feed();
   report_probe_parameters(); // Print probe parameters. Not persistent in memory.
+  printPgmString(PSTR("[JRN:")); // Print the journal. Position when last stored, cuts, arc time in sec and setpoint.
+  float print_position[N_AXIS];
+  system_convert_array_steps_to_mpos(print_position,journal.position);
+  report_util_axis_values(print_position);
+  serial_write(':');
+  print_uint32_base10(journal.cut_count);
+  serial_write(',');
+  print_uint32_base10(journal.arc_time/1000);
+  serial_write(',');
+  print_uint32_base10(journal.thc_setpoint);
+  report_util_feedback_line_feed();
 }
 
 
@@ -361,6 +490,43 @@ void report_startup_line(uint8_t n, char *line)
   report_util_line_feed();
 }
 
+// Prints the cut parameter profiles. [Pn:max rates:accelerations:junction deviation:target,deadband,arc delay:active]
+// NOTE: Read here rather than by the '$P' command, to keep the profile off the deepest stack path.
+void report_profiles()
+{
+  settings_profile_t profile;
+  uint8_t n, idx;
+  for (n=0; n<N_PROFILE; n++) {
+    if (!(settings_read_profile(n, &profile))) {
+      report_status_message(STATUS_SETTING_READ_FAIL);
+      continue;
+    }
+    printPgmString(PSTR("[P"));
+    print_uint8_base10(n);
+    serial_write(':');
+    for (idx=0; idx<N_AXIS; idx++) {
+      printFloat(profile.max_rate[idx],N_DECIMAL_SETTINGVALUE);
+      if (idx < (N_AXIS-1)) { serial_write(','); }
+    }
+    serial_write(':');
+    for (idx=0; idx<N_AXIS; idx++) {
+      printFloat(profile.acceleration[idx]/(60*60),N_DECIMAL_SETTINGVALUE); // Convert from mm/min^2 for human readability
+      if (idx < (N_AXIS-1)) { serial_write(','); }
+    }
+    serial_write(':');
+    printFloat(profile.junction_deviation,N_DECIMAL_SETTINGVALUE);
+    serial_write(':');
+    print_uint32_base10(profile.thc_target);
+    serial_write(',');
+    print_uint8_base10(profile.thc_deadband);
+    serial_write(',');
+    print_uint32_base10(profile.thc_arc_delay);
+    serial_write(':');
+    print_uint8_base10(n == settings_profile);
+    report_util_feedback_line_feed();
+  }
+}
+
 void report_execute_startup_message(char *line, uint8_t status_code)
 {
   serial_write('>');
@@ -523,6 +689,41 @@ void report_realtime_status()
   {
     printPgmString(PSTR("false"));
   }
+  uint8_t sreg = SREG;
+  cli();
+  int32_t thc_offset = sys_thc_offset;
+  uint16_t kerf_hold_count = thc_kerf_hold_count;
+  uint16_t underrun_count = sys_buffer_stats.underruns;
+  SREG = sreg;
+  printPgmString(PSTR(", \"UNDERRUNS\": "));
+  print_uint32_base10(underrun_count);
+  printPgmString(PSTR(", \"THC_OFFSET\": "));
+  printFloat_CoordValue(thc_offset/settings.steps_per_mm[Z_AXIS]);
+  printPgmString(PSTR(", \"KERF_HOLDS\": "));
+  print_uint32_base10(kerf_hold_count);
+  printPgmString(PSTR(", \"THC_CLAMPED\": "));
+  if (thc_z_clamped) { printPgmString(PSTR("true")); }
+  else { printPgmString(PSTR("false")); }
+
+  #ifdef ENABLE_THC_CAPTURE
+    // Drain pending arc voltage capture records as a hex string of packed little-endian records.
+    // Record layout: time(2), adc(2), z_steps(1), feed(2). See 'extra/thc_capture.py'.
+    thc_capture_t record;
+    uint8_t chunk = THC_CAPTURE_CHUNK_SIZE;
+    if (thc_capture_read(&record)) {
+      printPgmString(PSTR(", \"CAP\": \""));
+      do {
+        uint8_t *ptr = (uint8_t*)&record;
+        for (uint8_t idx=0; idx<sizeof(thc_capture_t); idx++) { print_uint8_base16(ptr[idx]); }
+      } while (--chunk && thc_capture_read(&record));
+      serial_write('"');
+    }
+    uint8_t dropped = thc_capture_get_dropped();
+    if (dropped) {
+      printPgmString(PSTR(", \"CAP_DROP\": "));
+      print_uint8_base10(dropped);
+    }
+  #endif
   printPgmString(PSTR(" }"));
   report_util_line_feed();
 }
@@ -83,6 +83,9 @@
 #define MESSAGE_RESTORE_DEFAULTS 9
 #define MESSAGE_SPINDLE_RESTORE 10
 #define MESSAGE_SLEEP_MODE 11
+#define MESSAGE_ARC_LOST 12
+#define MESSAGE_THC_CLAMPED 13
+#define MESSAGE_THC_SETPOINT_RESTORED 14
 
 // Prints system status messages.
 void report_status_message(uint8_t status_code);
@@ -93,6 +96,20 @@ void report_alarm_message(uint8_t alarm_code);
 // Prints miscellaneous feedback messages.
 void report_feedback_message(uint8_t message_code);
 
+// Prints the THC setpoint locked in by the arc voltage sample mode.
+void report_thc_sample();
+
+// Prints the per-cut THC telemetry record at torch off, if a cut was started.
+void report_thc_cut();
+
+// Prints the buffer fill statistics for $B.
+void report_buffer_stats();
+
+#ifdef ENABLE_DUAL_AXIS
+  // Prints the dual axis switch skew measured by homing
+  void report_homing_dual_skew(float skew);
+#endif
+
 // Prints welcome message
 void report_init_message();
 
@@ -119,6 +136,9 @@ void report_gcode_modes();
 
 // Prints startup line when requested and executed.
 void report_startup_line(uint8_t n, char *line);
+
+// Prints the cut parameter profiles
+void report_profiles();
 void report_execute_startup_message(char *line, uint8_t status_code);
 
 // Prints build info and user info
@@ -143,11 +143,41 @@ uint8_t serial_read()
 volatile bool jog_z_up;
 volatile bool jog_z_down;
 
+// Two-byte command, an override set or continuous jog, awaiting its value byte. Zero if none.
+static uint8_t serial_value_cmd;
+
 ISR(SERIAL_RX)
 {
   uint8_t data = UDR0;
   uint8_t next_head;
 
+  // The byte after a two-byte command is its value, whatever it is, short of a reset. Set it, to
+  // be applied in the next realtime pass, and keep it out of the main buffer. A reset drops the
+  // command and is executed below, so a lost value byte can't swallow it.
+  if (serial_value_cmd && (data != CMD_RESET)) {
+    switch (serial_value_cmd) {
+      case CMD_FEED_OVR_SET: sys_rt_feed_ovr_set = data; break;
+      case CMD_RAPID_OVR_SET: sys_rt_rapid_ovr_set = data; break;
+      case CMD_SPINDLE_OVR_SET: sys_rt_spindle_ovr_set = data; break;
+      #ifdef ENABLE_CONTINUOUS_JOG
+        case CMD_JOG_CONTINUOUS:
+          // Planned in the main loop. Only from idle or a jog, which is canceled for a new direction.
+          data &= JOG_CONTINUOUS_MASK;
+          if (!data) { break; }
+          if (sys.state & STATE_JOG) {
+            if (data == jog_continuous_active) { break; } // Already jogging this way.
+            system_set_exec_state_flag(EXEC_MOTION_CANCEL);
+          } else if (sys.state != STATE_IDLE) { break; }
+          jog_continuous = data;
+          break;
+      #endif
+    }
+    serial_value_cmd = 0;
+    return;
+  }
+
+  serial_value_cmd = 0;
+
   // Pick off realtime command characters directly from the serial stream. These characters are
   // not passed into the main buffer, but these set system state flag bits for realtime execution.
   switch (data) {
@@ -167,6 +197,10 @@ ISR(SERIAL_RX)
         switch(data) {
           case CMD_SAFETY_DOOR:   system_set_exec_state_flag(EXEC_SAFETY_DOOR); break; // Set as true
           case CMD_JOG_CANCEL:   
+            #ifdef ENABLE_CONTINUOUS_JOG
+              jog_continuous = 0;
+              jog_continuous_active = 0;
+            #endif
             if (sys.state & STATE_JOG) { // Block all other states from invoking motion cancel.
               system_set_exec_state_flag(EXEC_MOTION_CANCEL); 
             }
@@ -189,9 +223,16 @@ ISR(SERIAL_RX)
           case CMD_SPINDLE_OVR_FINE_MINUS: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_FINE_MINUS); break;
           case CMD_SPINDLE_OVR_STOP: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_STOP); break;
           case CMD_COOLANT_FLOOD_OVR_TOGGLE: system_set_exec_accessory_override_flag(EXEC_COOLANT_FLOOD_OVR_TOGGLE); break;
+          case CMD_FEED_OVR_SET: case CMD_RAPID_OVR_SET: case CMD_SPINDLE_OVR_SET: serial_value_cmd = data; break;
           #ifdef ENABLE_M7
             case CMD_COOLANT_MIST_OVR_TOGGLE: system_set_exec_accessory_override_flag(EXEC_COOLANT_MIST_OVR_TOGGLE); break;
           #endif
+          #ifdef ENABLE_CONTINUOUS_JOG
+            case CMD_JOG_SPEED_SLOW: jog_continuous_speed = JOG_CONTINUOUS_SPEED_SLOW; break;
+            case CMD_JOG_SPEED_MEDIUM: jog_continuous_speed = JOG_CONTINUOUS_SPEED_MEDIUM; break;
+            case CMD_JOG_SPEED_FAST: jog_continuous_speed = JOG_CONTINUOUS_SPEED_FAST; break;
+            case CMD_JOG_CONTINUOUS: serial_value_cmd = data; break;
+          #endif
         }
         // Throw away any unfound extended-ASCII character by not passing it to the serial buffer.
       } else { // Write character to buffer
@@ -202,6 +243,11 @@ ISR(SERIAL_RX)
         if (next_head != serial_rx_buffer_tail) {
           serial_rx_buffer[serial_rx_buffer_head] = data;
           serial_rx_buffer_head = next_head;
+          // Track the RX high-water mark for $B.
+          if (sys.state == STATE_CYCLE) {
+            uint8_t count = serial_get_rx_buffer_count();
+            if (count > sys_buffer_stats.serial_rx_max) { sys_buffer_stats.serial_rx_max = count; }
+          }
         }
       }
   }
@@ -211,4 +257,5 @@ ISR(SERIAL_RX)
 void serial_reset_read_buffer()
 {
   serial_rx_buffer_tail = serial_rx_buffer_head;
+  serial_value_cmd = 0;
 }
@@ -23,6 +23,12 @@
 
 settings_t settings;
 
+uint8_t settings_profile = PROFILE_NONE;
+
+// Global settings must end before the profiles, and the profiles before the journal region.
+typedef char settings_eeprom_check[(EEPROM_ADDR_GLOBAL+sizeof(settings_t)+1 <= EEPROM_ADDR_PROFILES) ? 1 : -1];
+typedef char profile_eeprom_check[(EEPROM_ADDR_PROFILES+N_PROFILE*(sizeof(settings_profile_t)+1) <= EEPROM_ADDR_JOURNAL) ? 1 : -1];
+
 const __flash settings_t defaults = {\
     .pulse_microseconds = DEFAULT_STEP_PULSE_MICROSECONDS,
     .stepper_idle_lock_time = DEFAULT_STEPPER_IDLE_LOCK_TIME,
@@ -38,6 +44,23 @@ const __flash settings_t defaults = {\
     .homing_seek_rate = DEFAULT_HOMING_SEEK_RATE,
     .homing_debounce_delay = DEFAULT_HOMING_DEBOUNCE_DELAY,
     .homing_pulloff = DEFAULT_HOMING_PULLOFF,
+    .thc_target = DEFAULT_THC_TARGET,
+    .thc_deadband = DEFAULT_THC_DEADBAND,
+    .thc_enable_threshold = DEFAULT_THC_ENABLE_THRESHOLD,
+    .thc_arc_delay = DEFAULT_THC_ARC_DELAY,
+    .thc_z_rate = DEFAULT_THC_Z_RATE,
+    .thc_z_accel = DEFAULT_THC_Z_ACCEL,
+    .thc_sample_time = DEFAULT_THC_SAMPLE_TIME,
+    .thc_velocity_threshold = DEFAULT_THC_VELOCITY_THRESHOLD,
+    .thc_kerf_slope = DEFAULT_THC_KERF_SLOPE,
+    .thc_kerf_hold_time = DEFAULT_THC_KERF_HOLD_TIME,
+    .thc_arc_lost_time = DEFAULT_THC_ARC_LOST_TIME,
+    .thc_repierce_retries = DEFAULT_THC_REPIERCE_RETRIES,
+    .thc_pierce_delay = DEFAULT_THC_PIERCE_DELAY,
+    .thc_max_excursion = DEFAULT_THC_MAX_EXCURSION,
+    .homing_dual_offset = DEFAULT_HOMING_DUAL_OFFSET,
+    .probe_retract = DEFAULT_PROBE_RETRACT,
+    .probe_feed_rate = DEFAULT_PROBE_FEED_RATE,
     .flags = (DEFAULT_REPORT_INCHES << BIT_REPORT_INCHES) | \
              (DEFAULT_LASER_MODE << BIT_LASER_MODE) | \
              (DEFAULT_INVERT_ST_ENABLE << BIT_INVERT_ST_ENABLE) | \
@@ -91,6 +114,62 @@ void settings_write_coord_data(uint8_t coord_select, float *coord_data)
 }
 
 
+// Copies the profile subset of a settings struct.
+static void settings_get_profile(settings_profile_t *profile, settings_t *source)
+{
+  memcpy(profile->max_rate, source->max_rate, sizeof(profile->max_rate));
+  memcpy(profile->acceleration, source->acceleration, sizeof(profile->acceleration));
+  profile->junction_deviation = source->junction_deviation;
+  profile->thc_target = source->thc_target;
+  profile->thc_deadband = source->thc_deadband;
+  profile->thc_arc_delay = source->thc_arc_delay;
+}
+
+
+// Copies a profile over the profile subset of a settings struct.
+static void settings_put_profile(settings_t *destination, settings_profile_t *profile)
+{
+  memcpy(destination->max_rate, profile->max_rate, sizeof(destination->max_rate));
+  memcpy(destination->acceleration, profile->acceleration, sizeof(destination->acceleration));
+  destination->junction_deviation = profile->junction_deviation;
+  destination->thc_target = profile->thc_target;
+  destination->thc_deadband = profile->thc_deadband;
+  destination->thc_arc_delay = profile->thc_arc_delay;
+}
+
+
+// Reads one field of the global settings record in EEPROM, without checking the record checksum.
+static void settings_read_global_field(void *field, uint16_t offset, uint8_t size)
+{
+  char *destination = (char*)field;
+  unsigned int addr = EEPROM_ADDR_GLOBAL + offset;
+  for (; size > 0; size--) { *(destination++) = eeprom_get_char(addr++); }
+}
+
+
+// Reads the profile subset of the global settings in EEPROM. The record was checked at startup
+// and is only ever written whole, so the fields are read in place.
+static void settings_read_global_profile(settings_profile_t *profile)
+{
+  settings_read_global_field(profile->max_rate, offsetof(settings_t, max_rate), sizeof(profile->max_rate));
+  settings_read_global_field(profile->acceleration, offsetof(settings_t, acceleration), sizeof(profile->acceleration));
+  settings_read_global_field(&profile->junction_deviation, offsetof(settings_t, junction_deviation), sizeof(profile->junction_deviation));
+  settings_read_global_field(&profile->thc_target, offsetof(settings_t, thc_target), sizeof(profile->thc_target));
+  settings_read_global_field(&profile->thc_deadband, offsetof(settings_t, thc_deadband), sizeof(profile->thc_deadband));
+  settings_read_global_field(&profile->thc_arc_delay, offsetof(settings_t, thc_arc_delay), sizeof(profile->thc_arc_delay));
+}
+
+
+// Method to store the current settings as a cut parameter profile into EEPROM
+void settings_store_profile(uint8_t n)
+{
+  settings_profile_t profile;
+  settings_get_profile(&profile, &settings);
+  uint32_t addr = n*(sizeof(settings_profile_t)+1) + EEPROM_ADDR_PROFILES;
+  memcpy_to_eeprom_with_checksum(addr,(char*)&profile, sizeof(settings_profile_t));
+}
+
+
 // Method to store Grbl global settings struct and version number into EEPROM
 // NOTE: This function can only be called in IDLE state.
 void write_global_settings()
@@ -104,6 +183,7 @@ void write_global_settings()
 void settings_restore(uint8_t restore_flag) {
   if (restore_flag & SETTINGS_RESTORE_DEFAULTS) {    
     settings = defaults;
+    settings_profile = PROFILE_NONE; // The defaults replace any loaded profile in RAM.
     write_global_settings();
   }
 
@@ -129,6 +209,13 @@ void settings_restore(uint8_t restore_flag) {
     eeprom_put_char(EEPROM_ADDR_BUILD_INFO , 0);
     eeprom_put_char(EEPROM_ADDR_BUILD_INFO+1 , 0); // Checksum
   }
+
+  if (restore_flag & SETTINGS_RESTORE_JOURNAL) { journal_reset(); }
+
+  if (restore_flag & SETTINGS_RESTORE_PROFILES) {
+    uint8_t idx;
+    for (idx=0; idx < N_PROFILE; idx++) { settings_store_profile(idx); } // Restored defaults, if also flagged.
+  }
 }
 
 
@@ -173,6 +260,28 @@ uint8_t settings_read_coord_data(uint8_t coord_select, float *coord_data)
 }
 
 
+// Reads a cut parameter profile from EEPROM. Updates pointed profile.
+uint8_t settings_read_profile(uint8_t n, settings_profile_t *profile)
+{
+  uint32_t addr = n*(sizeof(settings_profile_t)+1) + EEPROM_ADDR_PROFILES;
+  return(memcpy_from_eeprom_with_checksum((char*)profile, addr, sizeof(settings_profile_t)));
+}
+
+
+// Loads a cut parameter profile into the settings in RAM. The EEPROM copy of the global settings
+// is untouched, so a power cycle returns to them.
+uint8_t settings_load_profile(uint8_t n)
+{
+  settings_profile_t profile;
+  if (!settings_read_profile(n, &profile)) { return(STATUS_SETTING_READ_FAIL); }
+  settings_put_profile(&settings, &profile);
+  analogSetVal = settings.thc_target;
+  thc_init();
+  settings_profile = n;
+  return(STATUS_OK);
+}
+
+
 // Reads Grbl global settings struct from EEPROM.
 uint8_t read_global_settings() {
   // Check version-byte of eeprom
@@ -189,9 +298,9 @@ uint8_t read_global_settings() {
 }
 
 
-// A helper method to set settings from command line
-uint8_t settings_store_global_setting(uint8_t parameter, float value) {
-  if (value < 0.0) { return(STATUS_NEGATIVE_VALUE); }
+// Sets a setting in RAM from the command line. Stored by settings_store_global_setting().
+static uint8_t settings_set_global_setting(uint8_t parameter, float value) {
+  if ((value < 0.0) && (parameter != 54)) { return(STATUS_NEGATIVE_VALUE); } // $54 is signed.
   if (parameter >= AXIS_SETTINGS_START_VAL) {
     // Store axis configuration. Axis numbering sequence set by AXIS_SETTING defines.
     // NOTE: Ensure the setting index corresponds to the report.c settings printout.
@@ -294,15 +403,87 @@ uint8_t settings_store_global_setting(uint8_t parameter, float value) {
           return(STATUS_SETTING_DISABLED_LASER);
         #endif
         break;
+      case 40:
+        if (value > 1023.0) { return(STATUS_INVALID_STATEMENT); } // 10-bit ADC range.
+        settings.thc_target = trunc(value);
+        analogSetVal = settings.thc_target;
+        break;
+      case 41: settings.thc_deadband = int_value; break;
+      case 42:
+        if (value > 1023.0) { return(STATUS_INVALID_STATEMENT); } // 10-bit ADC range.
+        settings.thc_enable_threshold = trunc(value);
+        break;
+      case 43:
+        if (value > 60000.0) { return(STATUS_INVALID_STATEMENT); }
+        settings.thc_arc_delay = trunc(value);
+        break;
+      case 44:
+        if (value == 0.0) { return(STATUS_INVALID_STATEMENT); }
+        settings.thc_z_rate = value;
+        break;
+      case 45:
+        if (value > 60000.0) { return(STATUS_INVALID_STATEMENT); }
+        settings.thc_sample_time = trunc(value);
+        break;
+      case 46:
+        if (value > 100.0) { return(STATUS_INVALID_STATEMENT); }
+        settings.thc_velocity_threshold = int_value;
+        break;
+      case 47: settings.thc_kerf_slope = int_value; break;
+      case 48:
+        if (value > 60000.0) { return(STATUS_INVALID_STATEMENT); }
+        settings.thc_kerf_hold_time = trunc(value);
+        break;
+      case 49:
+        if (value == 0.0) { return(STATUS_INVALID_STATEMENT); }
+        settings.thc_z_accel = value;
+        break;
+      case 50:
+        if (value > 60000.0) { return(STATUS_INVALID_STATEMENT); }
+        settings.thc_arc_lost_time = trunc(value);
+        break;
+      case 51: settings.thc_repierce_retries = int_value; break;
+      case 52:
+        if (value > 60000.0) { return(STATUS_INVALID_STATEMENT); }
+        settings.thc_pierce_delay = trunc(value);
+        break;
+      case 53: settings.thc_max_excursion = value; break;
+      case 54: settings.homing_dual_offset = value; break;
+      case 55: settings.probe_retract = value; break;
+      case 56: settings.probe_feed_rate = value; break;
       default:
         return(STATUS_INVALID_STATEMENT);
     }
   }
-  write_global_settings();
   return(STATUS_OK);
 }
 
 
+// A helper method to set settings from command line. A loaded profile only lives in RAM, so the
+// stored global values are swapped back in while the setting is changed and written. The profile
+// then goes back over them, taking the new value if the setting is one of its own.
+uint8_t settings_store_global_setting(uint8_t parameter, float value) {
+  settings_profile_t active, global, changed;
+  if (settings_profile != PROFILE_NONE) {
+    settings_get_profile(&active, &settings);
+    settings_read_global_profile(&global);
+    settings_put_profile(&settings, &global);
+  }
+  uint8_t status_code = settings_set_global_setting(parameter, value);
+  if (status_code == STATUS_OK) { write_global_settings(); }
+  if (settings_profile != PROFILE_NONE) {
+    settings_get_profile(&changed, &settings);
+    uint8_t idx;
+    for (idx=0; idx<sizeof(settings_profile_t); idx++) {
+      if (((char*)&changed)[idx] != ((char*)&global)[idx]) { ((char*)&active)[idx] = ((char*)&changed)[idx]; }
+    }
+    settings_put_profile(&settings, &active);
+  }
+  if (status_code == STATUS_OK) { thc_init(); } // Recompute THC Z ramp and step window. Depends on Z, soft limit and THC settings.
+  return(status_code);
+}
+
+
 // Initialize the config subsystem
 void settings_init() {
   if(!read_global_settings()) {
@@ -310,6 +491,7 @@ void settings_init() {
     settings_restore(SETTINGS_RESTORE_ALL); // Force restore all EEPROM data.
     report_grbl_settings();
   }
+  journal_init(); // Load the newest valid journal record.
 }
 
 
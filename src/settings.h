@@ -27,7 +27,7 @@
 
 // Version of the EEPROM data. Will be used to migrate existing data from older versions of Grbl
 // when firmware is upgraded. Always stored in byte 0 of eeprom
-#define SETTINGS_VERSION 10  // NOTE: Check settings_reset() when moving to next version.
+#define SETTINGS_VERSION 11  // NOTE: Check settings_reset() when moving to next version.
 
 // Define bit flag masks for the boolean settings in settings.flag.
 #define BIT_REPORT_INCHES      0
@@ -57,15 +57,22 @@
 #define SETTINGS_RESTORE_PARAMETERS bit(1)
 #define SETTINGS_RESTORE_STARTUP_LINES bit(2)
 #define SETTINGS_RESTORE_BUILD_INFO bit(3)
+#define SETTINGS_RESTORE_JOURNAL bit(4)
+#define SETTINGS_RESTORE_PROFILES bit(5)
 #ifndef SETTINGS_RESTORE_ALL
   #define SETTINGS_RESTORE_ALL 0xFF // All bitflags
 #endif
 
 // Define EEPROM memory address location values for Grbl settings and parameters
 // NOTE: The Atmega328p has 1KB EEPROM. The upper half is reserved for parameters and
-// the startup script. The lower half contains the global settings and space for future
-// developments.
+// the startup script. The lower half contains the global settings, the journal at its
+// top end and space for future developments in between.
 #define EEPROM_ADDR_GLOBAL         1U
+// NOTE: Each profile slot is its 33 data bytes plus a checksum, so N_PROFILE 4 ends at 176+4*34 = 312,
+// 8 bytes short of the journal. A fifth profile or a new profile field needs the journal moved up.
+#define EEPROM_ADDR_PROFILES       176U // N_PROFILE profiles with checksums. Ends before the journal.
+#define EEPROM_ADDR_JOURNAL        320U
+#define EEPROM_JOURNAL_SIZE        192U // Rotated through in whole records. See journal.h.
 #define EEPROM_ADDR_PARAMETERS     512U
 #define EEPROM_ADDR_STARTUP_BLOCK  768U
 #define EEPROM_ADDR_BUILD_INFO     942U
@@ -110,9 +117,44 @@ typedef struct {
   float homing_seek_rate;
   uint16_t homing_debounce_delay;
   float homing_pulloff;
+  float homing_dual_offset;     // Dual axis squaring offset in mm. Positive steps the dual motor, negative the main.
+
+  float probe_retract;          // Two-stage probe retract after the seek trigger, in mm. Zero disables.
+  float probe_feed_rate;        // Two-stage probe slow re-probe rate in mm/min.
+
+  // Torch height control settings
+  uint16_t thc_target;          // Arc voltage target in ADC counts. Loaded as the THC setpoint upon reset, except at
+                                // power-up when the journal holds a setpoint.
+  uint8_t thc_deadband;         // ADC counts either side of the target where no correction is made.
+  uint16_t thc_enable_threshold; // THC is disabled when the setpoint is at or below this value.
+  uint16_t thc_arc_delay;       // Arc stabilization delay after ARC_OK before correcting, in msec.
+  float thc_z_rate;             // THC Z correction max rate in mm/min.
+  float thc_z_accel;            // THC Z correction acceleration in mm/sec^2.
+  uint16_t thc_sample_time;     // Arc voltage sample window in msec. Zero disables sample mode.
+  uint8_t thc_velocity_threshold; // THC anti-dive. Percent of programmed rate below which Z is held.
+  uint8_t thc_kerf_slope;       // Kerf crossing arc voltage slope in filtered ADC counts per msec. Zero disables.
+  uint16_t thc_kerf_hold_time;  // Maximum time Z is held after a kerf crossing is detected, in msec.
+  uint16_t thc_arc_lost_time;   // ARC_OK dropout debounce time before a feed hold, in msec. Zero disables.
+  uint8_t thc_repierce_retries; // Automatic re-pierce attempts per cut after an arc loss.
+  uint16_t thc_pierce_delay;    // Re-pierce delay after ARC_OK before resuming motion, in msec.
+  float thc_max_excursion;      // Max THC Z offset either way from the programmed height, in mm. Zero disables.
 } settings_t;
 extern settings_t settings;
 
+// Cut parameter profile. The settings swapped in by $P=n upon a material or thickness change.
+// NOTE: Packed so the EEPROM slot size is the sum of the fields on padded host builds too.
+typedef struct __attribute__((packed)) {
+  float max_rate[N_AXIS];
+  float acceleration[N_AXIS];
+  float junction_deviation;
+  uint16_t thc_target;
+  uint8_t thc_deadband;
+  uint16_t thc_arc_delay;
+} settings_profile_t;
+
+#define PROFILE_NONE 0xFF
+extern uint8_t settings_profile; // Profile loaded by $P=n. PROFILE_NONE upon power-up.
+
 // Initialize the configuration subsystem (load settings from EEPROM)
 void settings_init();
 
@@ -140,6 +182,15 @@ void settings_write_coord_data(uint8_t coord_select, float *coord_data);
 // Reads selected coordinate data from EEPROM
 uint8_t settings_read_coord_data(uint8_t coord_select, float *coord_data);
 
+// Stores the current settings as profile n in EEPROM
+void settings_store_profile(uint8_t n);
+
+// Reads profile n from EEPROM
+uint8_t settings_read_profile(uint8_t n, settings_profile_t *profile);
+
+// Loads profile n into the settings in RAM only
+uint8_t settings_load_profile(uint8_t n);
+
 // Returns the step pin mask according to Grbl's internal axis numbering
 uint8_t get_step_pin_mask(uint8_t i);
 
@@ -113,38 +113,8 @@ void spindle_stop()
       SPINDLE_ENABLE_PORT &= ~(1<<SPINDLE_ENABLE_BIT); // Set pin to low
     #endif
   #endif
-  /*if (thc_offset != 0)
-  {
-    jog_z_down = false;
-    jog_z_up = false;
-    printPgmString(PSTR("There is a THC offset that needs to be cleared!\n"));
-    if (thc_offset > 0) //We need a negative move
-    {
-      jog_z_down = true;
-      while(thc_offset > 0) //Wait until offset is cleared!
-      {
-        printPgmString(PSTR("THC_OFFSET(z-): "));
-        printInteger(thc_offset);
-        printPgmString(PSTR("\n\r"));
-      }
-      jog_z_down = false;
-    }
-    else //We need a possitive move
-    {
-      jog_z_up = true;
-      while(thc_offset < 0)
-      {
-        printPgmString(PSTR("THC_OFFSET(z+): "));
-        printInteger(thc_offset);
-        printPgmString(PSTR("\n\r"));
-      }
-      jog_z_up = false;
-    }
-    printPgmString(PSTR("Offset has been cleared!\n"));
-  }*/
   jog_z_down = false;
   jog_z_up = false;
-  plan_sync_position(); //Update planner for THC offset!
 }
 
 
@@ -311,6 +281,14 @@ void spindle_stop()
     if (sys.state == STATE_CHECK_MODE) { return; }
     protocol_buffer_synchronize(); // Empty planner buffer to ensure spindle is set when programmed.
     spindle_set_state(state,rpm);
+    if (state == SPINDLE_DISABLE) {
+      sys.thc_repierce_count = 0; // End of cut. Re-pierce retries are per cut.
+      report_thc_cut();
+      mc_thc_unwind(); // Torch off. Return Z to the programmed height.
+      journal_sync(); // Persist the cut tally and position.
+    } else {
+      thc_cut_begin();
+    }
   }
 #else
   void _spindle_sync(uint8_t state)
@@ -318,5 +296,13 @@ void spindle_stop()
     if (sys.state == STATE_CHECK_MODE) { return; }
     protocol_buffer_synchronize(); // Empty planner buffer to ensure spindle is set when programmed.
     _spindle_set_state(state);
+    if (state == SPINDLE_DISABLE) {
+      sys.thc_repierce_count = 0; // End of cut. Re-pierce retries are per cut.
+      report_thc_cut();
+      mc_thc_unwind(); // Torch off. Return Z to the programmed height.
+      journal_sync(); // Persist the cut tally and position.
+    } else {
+      thc_cut_begin();
+    }
   }
 #endif
@@ -74,7 +74,6 @@ typedef struct {
     uint8_t is_pwm_rate_adjusted; // Tracks motions that require constant laser power/rate
   #endif
 } st_block_t;
-static st_block_t st_block_buffer[SEGMENT_BUFFER_SIZE-1];
 
 // Primary stepper segment ring buffer. Contains small, short line segments for the stepper
 // algorithm to execute, which are "checked-out" incrementally from the first block in the
@@ -85,22 +84,50 @@ typedef struct {
   uint16_t cycles_per_tick;  // Step distance traveled per ISR tick, aka step rate.
   uint8_t  st_block_index;   // Stepper block data index. Uses this information to execute this segment.
   #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
-    uint8_t amass_level;    // Indicates AMASS level for the ISR to execute this segment
+    uint8_t amass_level;    // Indicates AMASS level for the ISR to execute this segment. Plus SEGMENT flags.
   #else
-    uint8_t prescaler;      // Without AMASS, a prescaler is required to adjust for slow timing.
+    uint8_t prescaler;      // Without AMASS, a prescaler is required to adjust for slow timing. Plus SEGMENT flags.
   #endif
   #ifdef VARIABLE_SPINDLE
     uint8_t spindle_pwm;
   #endif
 } segment_t;
+
+// The AMASS level and timer prescaler only use the low bits of their byte. The rest carries flags.
+#define SEGMENT_TIMING_MASK 0x0F
+#define SEGMENT_THC_LOCK    bit(7) // THC holds Z while this segment is below the anti-dive speed.
+
+// Segment buffer depth from the RAM budget, unless set directly. The stepper block buffer is one
+// smaller than the segment buffer, so each segment costs a segment_t and an st_block_t.
+#ifndef SEGMENT_BUFFER_SIZE
+  #define SEGMENT_BUFFER_SIZE ((SEGMENT_BUFFER_RAM_BUDGET+sizeof(st_block_t))/(sizeof(segment_t)+sizeof(st_block_t)))
+#endif
+typedef char segment_buffer_size_check[((SEGMENT_BUFFER_SIZE >= 3) && (SEGMENT_BUFFER_SIZE <= 255)) ? 1 : -1];
+
+static st_block_t st_block_buffer[SEGMENT_BUFFER_SIZE-1];
 static segment_t segment_buffer[SEGMENT_BUFFER_SIZE];
 
+// Stepper ISR motion modes. Homing and probing are always set up before their motion starts, so the
+// mode is selected once at wake up. Normal motion then skips the homing and probe state checks.
+#define ST_ISR_MODE_NORMAL   0 // Must be zero.
+#define ST_ISR_MODE_HOMING   bit(0) // Apply homing axis locks.
+#define ST_ISR_MODE_PROBING  bit(1) // Monitor the probe pin.
+
 // Stepper ISR data struct. Contains the running data for the main stepper ISR.
 typedef struct {
   // Used by the bresenham line algorithm
   uint32_t counter_x,        // Counter variables for the bresenham line tracer
            counter_y,
            counter_z;
+  uint16_t counter16_x,      // 16-bit counters. Used for blocks with less than 2^15 step events,
+           counter16_y,      // where the counters never exceed twice the step event count.
+           counter16_z;
+  uint8_t counter_16bit;     // Flags the executing block uses the 16-bit counters.
+
+  // Executing block data cached at block load, so the ISR doesn't read it through st.exec_block.
+  uint32_t step_event_count;
+  uint32_t steps[N_AXIS];    // Axis step counts. With AMASS, shifted by the segment AMASS level.
+  int8_t position_inc[N_AXIS]; // Machine position increment per axis step. +1 or -1.
   #ifdef STEP_PULSE_DELAY
     uint8_t step_bits;  // Stores out_bits output to complete the step pulse delay
   #endif
@@ -113,10 +140,7 @@ typedef struct {
     uint8_t step_outbits_dual;
     uint8_t dir_outbits_dual;
   #endif
-  #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
-    uint32_t steps[N_AXIS];
-  #endif
-
+  uint8_t isr_mode;          // Motion mode hooks run by the ISR. Selected at wake up. See ST_ISR_MODE.
   uint16_t step_count;       // Steps remaining in line segment motion
   uint8_t exec_block_index; // Tracks the current st_block index. Change indicates new block.
   st_block_t *exec_block;   // Pointer to the block data for the segment being executed
@@ -125,6 +149,9 @@ typedef struct {
 static stepper_t st;
 
 // Step segment ring buffer indices
+// THC anti-dive lock of the executing segment. Set by the stepper ISR, read by the THC in the Timer2 ISR.
+volatile uint8_t st_thc_lock;
+
 static volatile uint8_t segment_buffer_tail;
 static uint8_t segment_buffer_head;
 static uint8_t segment_next_head;
@@ -171,6 +198,7 @@ typedef struct {
   float exit_speed;       // Exit speed of executing block (mm/min)
   float accelerate_until; // Acceleration ramp end measured from end of block (mm)
   float decelerate_after; // Deceleration ramp start measured from end of block (mm)
+  float thc_lock_speed;   // THC anti-dive speed of executing block. Percentage of nominal speed. (mm/min)
 
   #ifdef VARIABLE_SPINDLE
     float inv_rate;    // Used by PWM laser mode to speed up segment calculations.
@@ -231,6 +259,11 @@ void st_wake_up()
   // Initialize stepper output bits to ensure first ISR call does not step.
   st.step_outbits = step_port_invert_mask;
 
+  // Select the ISR motion mode hooks for this motion.
+  if (sys.state == STATE_HOMING) { st.isr_mode = ST_ISR_MODE_HOMING; }
+  else if (sys_probe_state == PROBE_ACTIVE) { st.isr_mode = ST_ISR_MODE_PROBING; }
+  else { st.isr_mode = ST_ISR_MODE_NORMAL; }
+
   // Initialize step pulse timing from settings. Here to ensure updating after re-writing.
   #ifdef STEP_PULSE_DELAY
     // Set total step pulse time after direction pin set. Ad hoc computation from oscilloscope.
@@ -313,6 +346,8 @@ void st_go_idle()
    NOTE: This interrupt must be as efficient as possible and complete before the next ISR tick,
    which for Grbl must be less than 33.3usec (@30kHz ISR rate). Oscilloscope measured time in
    ISR is 5usec typical and 25usec maximum, well below requirement.
+   NOTE: extra/isr_cycles.py counts the shortest and longest paths through this ISR in a linked
+   build. Worth re-running after any change here, as the block load is the longest path.
    NOTE: This ISR expects at least one step to be executed per segment.
 */
 // TODO: Replace direct updating of the int32 position counters in the ISR somehow. Perhaps use smaller
@@ -357,9 +392,25 @@ ISR(TIMER1_COMPA_vect)
       // Initialize new step segment and load number of steps to execute
       st.exec_segment = &segment_buffer[segment_buffer_tail];
 
-      #ifndef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+      // Sample segment and planner buffer fill for $B.
+      if (sys.state == STATE_CYCLE) {
+        uint8_t queued;
+        if (segment_buffer_head > segment_buffer_tail) { queued = segment_buffer_head-segment_buffer_tail; }
+        else { queued = SEGMENT_BUFFER_SIZE-(segment_buffer_tail-segment_buffer_head); }
+        if (queued < sys_buffer_stats.segment_min) { sys_buffer_stats.segment_min = queued; }
+        if (queued > sys_buffer_stats.segment_max) { sys_buffer_stats.segment_max = queued; }
+        queued = (BLOCK_BUFFER_SIZE-1)-plan_get_block_buffer_available();
+        if (queued < sys_buffer_stats.planner_min) { sys_buffer_stats.planner_min = queued; }
+        if (queued > sys_buffer_stats.planner_max) { sys_buffer_stats.planner_max = queued; }
+      }
+
+      #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+        uint8_t amass_level = st.exec_segment->amass_level & SEGMENT_TIMING_MASK;
+        st_thc_lock = st.exec_segment->amass_level & SEGMENT_THC_LOCK;
+      #else
         // With AMASS is disabled, set timer prescaler for segments with slow step frequencies (< 250Hz).
-        TCCR1B = (TCCR1B & ~(0x07<<CS10)) | (st.exec_segment->prescaler<<CS10);
+        TCCR1B = (TCCR1B & ~(0x07<<CS10)) | ((st.exec_segment->prescaler & SEGMENT_TIMING_MASK)<<CS10);
+        st_thc_lock = st.exec_segment->prescaler & SEGMENT_THC_LOCK;
       #endif
 
       // Initialize step segment timing per step and load number of steps to execute.
@@ -371,8 +422,25 @@ ISR(TIMER1_COMPA_vect)
         st.exec_block_index = st.exec_segment->st_block_index;
         st.exec_block = &st_block_buffer[st.exec_block_index];
 
+        // Cache block data used on every step.
+        st.step_event_count = st.exec_block->step_event_count;
+        uint8_t direction_bits = st.exec_block->direction_bits;
+        st.position_inc[X_AXIS] = (direction_bits & (1<<X_DIRECTION_BIT)) ? -1 : 1;
+        st.position_inc[Y_AXIS] = (direction_bits & (1<<Y_DIRECTION_BIT)) ? -1 : 1;
+        st.position_inc[Z_AXIS] = (direction_bits & (1<<Z_DIRECTION_BIT)) ? -1 : 1;
+        #ifndef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+          st.steps[X_AXIS] = st.exec_block->steps[X_AXIS];
+          st.steps[Y_AXIS] = st.exec_block->steps[Y_AXIS];
+          st.steps[Z_AXIS] = st.exec_block->steps[Z_AXIS];
+        #endif
+
         // Initialize Bresenham line and distance counters
-        st.counter_x = st.counter_y = st.counter_z = (st.exec_block->step_event_count >> 1);
+        st.counter_16bit = (st.step_event_count < 0x8000);
+        if (st.counter_16bit) {
+          st.counter16_x = st.counter16_y = st.counter16_z = (st.step_event_count >> 1);
+        } else {
+          st.counter_x = st.counter_y = st.counter_z = (st.step_event_count >> 1);
+        }
       }
       st.dir_outbits = st.exec_block->direction_bits ^ dir_port_invert_mask;
       #ifdef ENABLE_DUAL_AXIS
@@ -381,9 +449,9 @@ ISR(TIMER1_COMPA_vect)
 
       #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
         // With AMASS enabled, adjust Bresenham axis increment counters according to AMASS level.
-        st.steps[X_AXIS] = st.exec_block->steps[X_AXIS] >> st.exec_segment->amass_level;
-        st.steps[Y_AXIS] = st.exec_block->steps[Y_AXIS] >> st.exec_segment->amass_level;
-        st.steps[Z_AXIS] = st.exec_block->steps[Z_AXIS] >> st.exec_segment->amass_level;
+        st.steps[X_AXIS] = st.exec_block->steps[X_AXIS] >> amass_level;
+        st.steps[Y_AXIS] = st.exec_block->steps[Y_AXIS] >> amass_level;
+        st.steps[Z_AXIS] = st.exec_block->steps[Z_AXIS] >> amass_level;
       #endif
 
       #ifdef VARIABLE_SPINDLE
@@ -392,7 +460,16 @@ ISR(TIMER1_COMPA_vect)
       #endif
 
     } else {
-      // Segment buffer empty. Shutdown.
+      // Segment buffer empty. Shutdown. If the planner still has motion and no hold or cancel is
+      // ending it, the segment generator didn't keep up and the machine stops mid-path.
+      // If the planner ran dry instead while the host still had g-code queued, it is a starvation.
+      // Not when the main program is draining the buffers on purpose, as for a spindle or dwell sync.
+      if (!(sys.step_control & STEP_CONTROL_END_MOTION)) {
+        if (plan_get_current_block() != NULL) { sys_buffer_stats.underruns++; }
+        else if ((sys.state == STATE_CYCLE) && !sys.buffer_sync && serial_get_rx_buffer_count()) {
+          sys_buffer_stats.starvations++;
+        }
+      }
       st_go_idle();
       #ifdef VARIABLE_SPINDLE
         // Ensure pwm is set properly upon completion of rate-controlled motion.
@@ -405,7 +482,9 @@ ISR(TIMER1_COMPA_vect)
 
 
   // Check probing state.
-  if (sys_probe_state == PROBE_ACTIVE) { probe_state_monitor(); }
+  if (st.isr_mode & ST_ISR_MODE_PROBING) {
+    if (sys_probe_state == PROBE_ACTIVE) { probe_state_monitor(); }
+  }
 
   // Reset step out bits.
   st.step_outbits = 0;
@@ -413,49 +492,64 @@ ISR(TIMER1_COMPA_vect)
     st.step_outbits_dual = 0;
   #endif
 
-  // Execute step displacement profile by Bresenham line algorithm
-  #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+  // Execute step displacement profile by Bresenham line algorithm. Block data is cached in st, and
+  // blocks with less than 2^15 step events use 16-bit counters. Positions are updated by the cached
+  // increment instead of branching on the direction bits.
+  if (st.counter_16bit) {
+    uint16_t step_event_count = st.step_event_count;
+    st.counter16_x += (uint16_t)st.steps[X_AXIS];
+    if (st.counter16_x > step_event_count) {
+      st.step_outbits |= (1<<X_STEP_BIT);
+      #if defined(ENABLE_DUAL_AXIS) && (DUAL_AXIS_SELECT == X_AXIS)
+        st.step_outbits_dual = (1<<DUAL_STEP_BIT);
+      #endif
+      st.counter16_x -= step_event_count;
+      sys_position[X_AXIS] += st.position_inc[X_AXIS];
+    }
+    st.counter16_y += (uint16_t)st.steps[Y_AXIS];
+    if (st.counter16_y > step_event_count) {
+      st.step_outbits |= (1<<Y_STEP_BIT);
+      #if defined(ENABLE_DUAL_AXIS) && (DUAL_AXIS_SELECT == Y_AXIS)
+        st.step_outbits_dual = (1<<DUAL_STEP_BIT);
+      #endif
+      st.counter16_y -= step_event_count;
+      sys_position[Y_AXIS] += st.position_inc[Y_AXIS];
+    }
+    st.counter16_z += (uint16_t)st.steps[Z_AXIS];
+    if (st.counter16_z > step_event_count) {
+      st.step_outbits |= (1<<Z_STEP_BIT);
+      st.counter16_z -= step_event_count;
+      sys_position[Z_AXIS] += st.position_inc[Z_AXIS];
+    }
+  } else {
     st.counter_x += st.steps[X_AXIS];
-  #else
-    st.counter_x += st.exec_block->steps[X_AXIS];
-  #endif
-  if (st.counter_x > st.exec_block->step_event_count) {
-    st.step_outbits |= (1<<X_STEP_BIT);
-    #if defined(ENABLE_DUAL_AXIS) && (DUAL_AXIS_SELECT == X_AXIS)
-      st.step_outbits_dual = (1<<DUAL_STEP_BIT);
-    #endif
-    st.counter_x -= st.exec_block->step_event_count;
-    if (st.exec_block->direction_bits & (1<<X_DIRECTION_BIT)) { sys_position[X_AXIS]--; }
-    else { sys_position[X_AXIS]++; }
-  }
-  #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+    if (st.counter_x > st.step_event_count) {
+      st.step_outbits |= (1<<X_STEP_BIT);
+      #if defined(ENABLE_DUAL_AXIS) && (DUAL_AXIS_SELECT == X_AXIS)
+        st.step_outbits_dual = (1<<DUAL_STEP_BIT);
+      #endif
+      st.counter_x -= st.step_event_count;
+      sys_position[X_AXIS] += st.position_inc[X_AXIS];
+    }
     st.counter_y += st.steps[Y_AXIS];
-  #else
-    st.counter_y += st.exec_block->steps[Y_AXIS];
-  #endif
-  if (st.counter_y > st.exec_block->step_event_count) {
-    st.step_outbits |= (1<<Y_STEP_BIT);
-    #if defined(ENABLE_DUAL_AXIS) && (DUAL_AXIS_SELECT == Y_AXIS)
-      st.step_outbits_dual = (1<<DUAL_STEP_BIT);
-    #endif
-    st.counter_y -= st.exec_block->step_event_count;
-    if (st.exec_block->direction_bits & (1<<Y_DIRECTION_BIT)) { sys_position[Y_AXIS]--; }
-    else { sys_position[Y_AXIS]++; }
-  }
-  #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+    if (st.counter_y > st.step_event_count) {
+      st.step_outbits |= (1<<Y_STEP_BIT);
+      #if defined(ENABLE_DUAL_AXIS) && (DUAL_AXIS_SELECT == Y_AXIS)
+        st.step_outbits_dual = (1<<DUAL_STEP_BIT);
+      #endif
+      st.counter_y -= st.step_event_count;
+      sys_position[Y_AXIS] += st.position_inc[Y_AXIS];
+    }
     st.counter_z += st.steps[Z_AXIS];
-  #else
-    st.counter_z += st.exec_block->steps[Z_AXIS];
-  #endif
-  if (st.counter_z > st.exec_block->step_event_count) {
-    st.step_outbits |= (1<<Z_STEP_BIT);
-    st.counter_z -= st.exec_block->step_event_count;
-    if (st.exec_block->direction_bits & (1<<Z_DIRECTION_BIT)) { sys_position[Z_AXIS]--; }
-    else { sys_position[Z_AXIS]++; }
+    if (st.counter_z > st.step_event_count) {
+      st.step_outbits |= (1<<Z_STEP_BIT);
+      st.counter_z -= st.step_event_count;
+      sys_position[Z_AXIS] += st.position_inc[Z_AXIS];
+    }
   }
 
   // During a homing cycle, lock out and prevent desired axes from moving.
-  if (sys.state == STATE_HOMING) { 
+  if (st.isr_mode & ST_ISR_MODE_HOMING) {
     st.step_outbits &= sys.homing_axis_lock;
     #ifdef ENABLE_DUAL_AXIS
       st.step_outbits_dual &= sys.homing_axis_lock_dual;
@@ -548,6 +642,7 @@ void st_reset()
   segment_buffer_head = 0; // empty = tail
   segment_next_head = 1;
   busy = false;
+  st_thc_lock = false;
 
   st_generate_step_dir_invert_masks();
   st.dir_outbits = dir_port_invert_mask; // Initialize direction bits to default.
@@ -788,6 +883,7 @@ void st_prep_buffer()
         }
 
         nominal_speed = plan_compute_profile_nominal_speed(pl_block);
+        prep.thc_lock_speed = nominal_speed*(0.01*settings.thc_velocity_threshold);
 				float nominal_speed_sqr = nominal_speed*nominal_speed;
 				float intersect_distance =
 								0.5*(pl_block->millimeters+inv_2_accel*(pl_block->entry_speed_sqr-exit_speed_sqr));
@@ -1048,6 +1144,21 @@ void st_prep_buffer()
       }
     #endif
 
+    /* -----------------------------------------------------------------------------------
+      Flag THC anti-dive for the segment. Arc voltage rises as the torch slows into corners
+      and small features, which the THC would otherwise chase by driving the torch down.
+      Feed holds always lock.
+    */
+    uint8_t thc_lock = true;
+    if (!(sys.step_control & STEP_CONTROL_EXECUTE_HOLD)) {
+      thc_lock = st_thc_lock_check(prep.current_speed, prep.exit_speed, prep.thc_lock_speed, (prep.ramp_type == RAMP_DECEL));
+    }
+    #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+      if (thc_lock) { prep_segment->amass_level |= SEGMENT_THC_LOCK; }
+    #else
+      if (thc_lock) { prep_segment->prescaler |= SEGMENT_THC_LOCK; }
+    #endif
+
     // Segment complete! Increment segment buffer indices, so stepper ISR can immediately execute it.
     segment_buffer_head = segment_next_head;
     if ( ++segment_next_head == SEGMENT_BUFFER_SIZE ) { segment_next_head = 0; }
@@ -22,10 +22,24 @@
 #ifndef stepper_h
 #define stepper_h
 
-#ifndef SEGMENT_BUFFER_SIZE
-  #define SEGMENT_BUFFER_SIZE 6
+// The segment buffer depth is derived in stepper.c from this RAM budget, unless SEGMENT_BUFFER_SIZE is set.
+#ifndef SEGMENT_BUFFER_RAM_BUDGET
+  #define SEGMENT_BUFFER_RAM_BUDGET 168
 #endif
 
+// THC anti-dive lock of the executing step segment. True when the THC should hold Z.
+extern volatile uint8_t st_thc_lock;
+
+// THC anti-dive lock decision for a prepped step segment. Lock Z when below the anti-dive speed, or as
+// soon as the planned deceleration ramp begins towards an exit speed below it, so the lock engages
+// ahead of the voltage rise. Called by st_prep_buffer().
+static inline uint8_t st_thc_lock_check(float current_speed, float exit_speed, float lock_speed, uint8_t is_decel)
+{
+  if (current_speed < lock_speed) { return(true); }
+  if (is_decel && (exit_speed < lock_speed)) { return(true); }
+  return(false);
+}
+
 // Initialize and setup the stepper motor subsystem
 void stepper_init();
 
@@ -168,6 +168,11 @@ uint8_t system_execute_line(char *line)
           break;
       }
       break;
+    case 'B' : // Print or clear buffer fill statistics [ANY STATE]
+      if (line[2] == 0) { report_buffer_stats(); }
+      else if ((line[2] == 'C') && (line[3] == 0)) { system_clear_buffer_stats(); }
+      else { return(STATUS_INVALID_STATEMENT); }
+      break;
     default :
       // Block any system command that requires the state as IDLE/ALARM. (i.e. EEPROM, homing)
       if ( !(sys.state == STATE_IDLE || sys.state == STATE_ALARM) ) { return(STATUS_IDLE_ERROR); }
@@ -217,24 +222,22 @@ uint8_t system_execute_line(char *line)
           #endif
           }
           break;
-        case 'T':
-          //printPgmString(PSTR("THC control!\n"));
-          if (line[2] == '=')
-          {
-            char v[5];
-            uint8_t vi = 0;
-            for (uint8_t i = 3; i < (3 + 5); i++)
-            {
-              if (line[i] == '\r' || line[i] == '\n') break;
-              v[vi] = line[i];
-              vi++;
-            }
-            analogSetVal = atoi(v);
-            //printPgmString(PSTR("Voltage = "));
-            //print_uint32_base10((uint16_t)analogSetVal);
-            //printPgmString(PSTR("\r\n"));
-          }
-        break;
+        case 'T' : // Set THC arc voltage setpoint in RAM only. Stored target is $40. [IDLE/ALARM]
+          if (line[++char_counter] != '=') { return(STATUS_INVALID_STATEMENT); }
+          char_counter++;
+          if (!read_float(line, &char_counter, &value)) { return(STATUS_BAD_NUMBER_FORMAT); }
+          if ((line[char_counter] != 0) || (value < 0.0) || (value > 1023.0)) { return(STATUS_INVALID_STATEMENT); }
+          analogSetVal = trunc(value);
+          break;
+        case 'P' : // Cut parameter profiles [IDLE/ALARM]
+          if ( line[++char_counter] == 0 ) { report_profiles(); break; } // Print profiles
+          if (line[char_counter] == 'S') { helper_var = true; char_counter++; } // Store current settings as profile.
+          if (line[char_counter++] != '=') { return(STATUS_INVALID_STATEMENT); }
+          if (!read_float(line, &char_counter, &value)) { return(STATUS_BAD_NUMBER_FORMAT); }
+          if ((line[char_counter] != 0) || (value < 0.0) || (value >= N_PROFILE)) { return(STATUS_INVALID_STATEMENT); }
+          if (helper_var) { settings_store_profile(trunc(value)); }
+          else { return(settings_load_profile(trunc(value))); } // Swap in RAM only. No EEPROM write.
+          break;
         case 'R' : // Restore defaults [IDLE/ALARM]
           if ((line[2] != 'S') || (line[3] != 'T') || (line[4] != '=') || (line[6] != 0)) { return(STATUS_INVALID_STATEMENT); }
           switch (line[5]) {
@@ -426,3 +429,30 @@ void system_clear_exec_accessory_overrides() {
   sys_rt_exec_accessory_override = 0;
   SREG = sreg;
 }
+
+// Returns and clears a pending override set value. Zero if none.
+uint8_t system_take_exec_ovr_set(volatile uint8_t *ovr_set) {
+  if (!(*ovr_set)) { return(0); }
+  uint8_t sreg = SREG;
+  cli();
+  uint8_t value = *ovr_set;
+  *ovr_set = 0;
+  SREG = sreg;
+  return(value);
+}
+
+void system_clear_exec_thc_flag(uint8_t mask) {
+  uint8_t sreg = SREG;
+  cli();
+  sys_rt_exec_thc &= ~(mask);
+  SREG = sreg;
+}
+
+void system_clear_buffer_stats() {
+  uint8_t sreg = SREG;
+  cli();
+  memset((void*)&sys_buffer_stats, 0, sizeof(buffer_stats_t));
+  sys_buffer_stats.segment_min = 0xFF; // Low-water marks start high. Reported as 0 until sampled.
+  sys_buffer_stats.planner_min = 0xFF;
+  SREG = sreg;
+}
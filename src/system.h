@@ -49,6 +49,12 @@
 #define EXEC_ALARM_HOMING_FAIL_APPROACH       9
 #define EXEC_ALARM_HOMING_FAIL_DUAL_APPROACH  10
 
+// THC executor bit map. Set by the THC update in the Timer2 ISR to request reports from the main program.
+#define EXEC_THC_SAMPLE_DONE  bit(0) // Arc voltage sample complete and locked in as the setpoint.
+#define EXEC_THC_SYNC_POSITION bit(1) // Z was jogged while stopped. Sync planner and g-code positions.
+#define EXEC_THC_ARC_LOST     bit(2) // ARC_OK dropped mid-cut. A feed hold has been issued.
+#define EXEC_THC_CLAMPED      bit(3) // A Z correction was stopped at the soft limits or max excursion.
+
 // Override bit maps. Realtime bitflags to control feed, rapid, spindle, and coolant overrides.
 // Spindle/coolant and feed/rapids are separated into two controlling flag variables.
 #define EXEC_FEED_OVR_RESET         bit(0)
@@ -144,6 +150,9 @@ typedef struct {
   #ifdef ENABLE_PARKING_OVERRIDE_CONTROL
     uint8_t override_ctrl;     // Tracks override control states.
   #endif
+  uint8_t thc_arc_lost;        // Tracks an arc loss hold. Torch is re-pierced before resuming.
+  uint8_t thc_repierce_count;  // Automatic re-pierce attempts made in the current cut.
+  uint8_t buffer_sync;         // Set while waiting for the buffers to empty, as for M3/M5 or a dwell.
   #ifdef VARIABLE_SPINDLE
     float spindle_speed;
   #endif
@@ -152,13 +161,36 @@ extern system_t sys;
 
 // NOTE: These position variables may need to be declared as volatiles, if problems arise.
 extern int32_t sys_position[N_AXIS];      // Real-time machine (aka home) position vector in steps.
+extern volatile int32_t sys_thc_offset;   // THC Z correction in steps, additive to sys_position[Z_AXIS].
 extern int32_t sys_probe_position[N_AXIS]; // Last probe position in machine coordinates and steps.
+extern int32_t sys_probe_seek_position[N_AXIS]; // Seek trigger position of the last two-stage probe, in steps.
 
 extern volatile uint8_t sys_probe_state;   // Probing state value.  Used to coordinate the probing cycle with stepper ISR.
 extern volatile uint8_t sys_rt_exec_state;   // Global realtime executor bitflag variable for state management. See EXEC bitmasks.
 extern volatile uint8_t sys_rt_exec_alarm;   // Global realtime executor bitflag variable for setting various alarms.
 extern volatile uint8_t sys_rt_exec_motion_override; // Global realtime executor bitflag variable for motion-based overrides.
 extern volatile uint8_t sys_rt_exec_accessory_override; // Global realtime executor bitflag variable for spindle/coolant overrides.
+extern volatile uint8_t sys_rt_feed_ovr_set;    // Feed override set by CMD_FEED_OVR_SET. Zero if none pending.
+extern volatile uint8_t sys_rt_rapid_ovr_set;   // Rapid override set by CMD_RAPID_OVR_SET. Zero if none pending.
+extern volatile uint8_t sys_rt_spindle_ovr_set; // Spindle override set by CMD_SPINDLE_OVR_SET. Zero if none pending.
+extern volatile uint8_t sys_rt_exec_thc; // Global realtime executor bitflag variable for THC events. See EXEC_THC bitmasks.
+
+// Buffer fill statistics for tracking down motion stalls, and limit input filter statistics. Written
+// by the stepper, serial RX and THC tick ISRs. Printed with $B and cleared with $BC or a reset.
+typedef struct {
+  uint8_t segment_min;   // Least step segments queued when the stepper loaded a segment.
+  uint8_t segment_max;
+  uint8_t planner_min;   // Least planner blocks queued when the stepper loaded a segment.
+  uint8_t planner_max;
+  uint8_t serial_rx_max; // Most bytes held in the serial RX buffer.
+  uint16_t underruns;    // Segment buffer ran dry with planner blocks still queued.
+  uint16_t starvations;  // Cycle stopped with an empty planner while streamed g-code was waiting.
+  #ifdef ENABLE_INPUT_FILTER
+    uint16_t limit_glitches;   // Limit pin changes rejected by the input filter.
+    uint8_t limit_latency_max; // Most THC ticks taken to accept a limit pin change.
+  #endif
+} buffer_stats_t;
+extern volatile buffer_stats_t sys_buffer_stats;
 
 #ifdef DEBUG
   #define EXEC_DEBUG_REPORT  bit(0)
@@ -207,6 +239,11 @@ void system_set_exec_motion_override_flag(uint8_t mask);
 void system_set_exec_accessory_override_flag(uint8_t mask);
 void system_clear_exec_motion_overrides();
 void system_clear_exec_accessory_overrides();
+uint8_t system_take_exec_ovr_set(volatile uint8_t *ovr_set);
+void system_clear_exec_thc_flag(uint8_t mask);
+
+// Clears the buffer fill statistics.
+void system_clear_buffer_stats();
 
 
 #endif
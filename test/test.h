@@ -0,0 +1,33 @@
+/*
+  test.h - Host test helpers
+  Part of Grbl
+
+  Host tests compile the pure logic of selected firmware modules with the native compiler. The AVR
+  build headers are skipped by predefining the grbl.h include guard, and each test declares the few
+  firmware globals it needs.
+*/
+
+#ifndef test_h
+#define test_h
+
+#define grbl_h // Skip grbl.h and the AVR headers it pulls in.
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "config.h"
+#include "nuts_bolts.h"
+
+static int test_failures;
+
+#define CHECK(cond) do { \
+  if (!(cond)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); test_failures++; } \
+} while (0)
+
+#define TEST_RESULT() (test_failures ? (printf("FAIL: %d\n", test_failures), 1) : (printf("OK\n"), 0))
+
+#endif
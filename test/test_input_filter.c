@@ -0,0 +1,108 @@
+/*
+  test_input_filter.c - Glitch replay of the hard limit input filter
+  Part of Grbl
+
+  Replays sampled pin patterns through the input filter, one character per THC tick, and checks which
+  changes are accepted, after how many ticks, and how many glitches are rejected. Includes the split
+  burst: two noise bursts each shorter than the window, separated by a single clean sample, which must
+  not add up to an accepted change.
+*/
+
+#include "test.h"
+#include "limits.h"
+
+typedef struct {
+  int accepted;    // Tick of the first accepted change, counted from 1. Zero if none.
+  int changes;     // Accepted changes.
+  int glitches;    // Rejected glitches.
+  uint8_t stable;  // Accepted pin state at the end.
+} replay_t;
+
+// Replays a pattern of '0' and '1' samples of one pin, from an accepted state of '0'.
+static replay_t replay(const char *pattern)
+{
+  input_filter_t filter = { 0, 0, 0, 0, 0 };
+  replay_t result = { 0, 0, 0, 0 };
+  int tick;
+  for (tick=1; *pattern; pattern++, tick++) {
+    uint8_t event = input_filter_update(&filter, (*pattern == '1'));
+    if (event == INPUT_FILTER_GLITCH) { result.glitches++; }
+    if (event == INPUT_FILTER_CHANGED) {
+      if (!result.changes) { result.accepted = tick; }
+      result.changes++;
+    }
+  }
+  result.stable = filter.stable;
+  return(result);
+}
+
+// Repeats a sample n times into buf.
+static char *fill(char *buf, char c, int n)
+{
+  while (n--) { *buf++ = c; }
+  *buf = 0;
+  return(buf);
+}
+
+int main()
+{
+  char pattern[256];
+  char *p;
+  replay_t r;
+  int n;
+
+  CHECK(INPUT_FILTER_SAMPLES >= 2);
+
+  // A clean hit is accepted after exactly the window.
+  p = fill(pattern, '0', 5);
+  fill(p, '1', 2*INPUT_FILTER_SAMPLES);
+  r = replay(pattern);
+  CHECK(r.accepted == 5+INPUT_FILTER_SAMPLES);
+  CHECK(r.changes == 1 && r.glitches == 0 && r.stable == 1);
+
+  // Bursts up to one sample short of the window are rejected.
+  for (n=1; n < INPUT_FILTER_SAMPLES; n++) {
+    p = fill(pattern, '0', 3);
+    p = fill(p, '1', n);
+    fill(p, '0', 20);
+    r = replay(pattern);
+    CHECK(r.changes == 0 && r.glitches == 1 && r.stable == 0);
+  }
+
+  // Split burst. Two sub-window bursts with a single clean sample between them are two glitches.
+  for (n=1; n < INPUT_FILTER_SAMPLES; n++) {
+    p = fill(pattern, '1', n);
+    p = fill(p, '0', 1);
+    p = fill(p, '1', INPUT_FILTER_SAMPLES-1);
+    fill(p, '0', 20);
+    r = replay(pattern);
+    CHECK(r.changes == 0 && r.glitches == 2 && r.stable == 0);
+  }
+
+  // Alternating noise never settles.
+  for (n=0; n < 201; n++) { pattern[n] = (n & 1) ? '1' : '0'; }
+  pattern[n] = 0;
+  r = replay(pattern);
+  CHECK(r.changes == 0 && r.glitches == 100);
+
+  // A bouncing hit is accepted once it settles for the window.
+  p = fill(pattern, '1', 2);
+  p = fill(p, '0', 1);
+  p = fill(p, '1', 3);
+  p = fill(p, '0', 2);
+  fill(p, '1', 2*INPUT_FILTER_SAMPLES);
+  r = replay(pattern);
+  CHECK(r.accepted == 8+INPUT_FILTER_SAMPLES);
+  CHECK(r.changes == 1 && r.glitches == 2 && r.stable == 1);
+
+  // A release is filtered like a hit, and a glitch during it is rejected.
+  p = fill(pattern, '1', INPUT_FILTER_SAMPLES);
+  p = fill(p, '0', INPUT_FILTER_SAMPLES-1);
+  p = fill(p, '1', 1);
+  fill(p, '0', INPUT_FILTER_SAMPLES);
+  r = replay(pattern);
+  CHECK(r.changes == 2 && r.glitches == 1 && r.stable == 0);
+  CHECK(r.accepted == INPUT_FILTER_SAMPLES);
+
+  return(TEST_RESULT());
+}
@@ -0,0 +1,128 @@
+/*
+  test_journal.c - Power-loss replay of the EEPROM journal
+  Part of Grbl
+
+  Backs the EEPROM with an array and cuts the power after every possible number of programmed bytes
+  of a record, in each slot of the journal. Upon the next power-up the torn record must be rejected
+  and the one before it restored, and a record written whole must supersede it. The write queue is
+  modeled as a fixed number of free entries per realtime checkpoint, so a store never waits on it.
+*/
+
+#include "test.h"
+#include "eeprom.h"
+#include "settings.h"
+#include "journal.h"
+
+#define QUEUE_FREE 3 // Free entries in an empty EEPROM write queue.
+
+uint8_t SREG;
+#define cli()
+int32_t sys_position[N_AXIS];
+volatile int32_t sys_thc_offset;
+volatile uint16_t analogSetVal;
+
+static uint8_t eeprom[1024];
+static int eeprom_writes_left; // Bytes programmed before the power is cut. Negative for no limit.
+static uint8_t queue_free;
+
+unsigned char eeprom_get_char(unsigned int addr) { return(eeprom[addr]); }
+
+void eeprom_put_char(unsigned int addr, unsigned char new_value)
+{
+  CHECK(addr >= EEPROM_ADDR_JOURNAL && addr < EEPROM_ADDR_JOURNAL+EEPROM_JOURNAL_SIZE);
+  CHECK(queue_free > 0); // A full queue would spin the caller.
+  if (queue_free) { queue_free--; }
+  if (eeprom_writes_left == 0) { return; } // Power lost. The byte is never programmed.
+  if (eeprom_writes_left > 0) { eeprom_writes_left--; }
+  eeprom[addr] = new_value;
+}
+
+unsigned char eeprom_queue_free() { return(queue_free); }
+
+#include "../src/journal.c"
+
+// Realtime checkpoints, each after the EE_READY interrupt has drained the queue.
+static void drain()
+{
+  uint8_t idx;
+  for (idx=0; idx < sizeof(journal_t); idx++) {
+    queue_free = QUEUE_FREE;
+    journal_write();
+  }
+}
+
+// Stores a record with values derived from n, as a cut ends.
+static void store(uint16_t n)
+{
+  analogSetVal = 400+n;
+  sys_position[X_AXIS] = 1000*n;
+  sys_position[Y_AXIS] = -1000*n;
+  sys_position[Z_AXIS] = 50*n;
+  sys_thc_offset = -n;
+  journal_add_cut(100*n);
+  queue_free = QUEUE_FREE;
+  journal_sync();
+}
+
+// Compares the fields only. The padding of a host build is not written in order.
+static int same(journal_t *a, journal_t *b)
+{
+  return((a->sequence == b->sequence) && (a->thc_setpoint == b->thc_setpoint) &&
+    (a->cut_count == b->cut_count) && (a->arc_time == b->arc_time) && (a->crc == b->crc) &&
+    (memcmp(a->position, b->position, sizeof(a->position)) == 0));
+}
+
+int main()
+{
+  journal_t before, after;
+  uint8_t slot, tear;
+  uint16_t n;
+
+  CHECK(JOURNAL_N_SLOTS >= 2);
+
+  for (slot=0; slot < JOURNAL_N_SLOTS+1; slot++) { // One past the last slot covers the wrap.
+    for (tear=0; tear <= sizeof(journal_t); tear++) {
+      memset(eeprom, 0xFF, sizeof(eeprom));
+      eeprom_writes_left = -1;
+      journal_init();
+      for (n=1; n <= slot+1; n++) { store(n); drain(); }
+      memcpy(&before, &journal, sizeof(journal_t));
+
+      eeprom_writes_left = tear; // Power lost after this many bytes.
+      store(n);
+      memcpy(&after, &journal, sizeof(journal_t));
+      drain();
+
+      eeprom_writes_left = -1; // Power-up.
+      journal_init();
+      if (tear <= offsetof(journal_t, crc)) { CHECK(same(&journal, &before)); }
+      else { CHECK(same(&journal, &after)); }
+
+      // The journal carries on from the restored record, into the next slot.
+      store(n+1);
+      drain();
+      journal_init();
+      CHECK(journal.sequence == (uint16_t)(before.sequence+1+(tear > offsetof(journal_t, crc))));
+      CHECK(journal.position[Z_AXIS] == 50*(n+1)-(n+1));
+    }
+  }
+
+  // A store before the last one is written abandons it. The one before stays valid until then.
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  eeprom_writes_left = -1;
+  journal_init();
+  store(1); drain();
+  memcpy(&before, &journal, sizeof(journal_t));
+  store(2); // Partly queued.
+  store(3);
+  memcpy(&after, &journal, sizeof(journal_t));
+  journal_init(); // Power lost before the rest is queued.
+  CHECK(same(&journal, &before));
+  store(1); store(2); store(3); drain();
+  memcpy(&after, &journal, sizeof(journal_t));
+  journal_init();
+  CHECK(same(&journal, &after));
+  CHECK(journal.cut_count == 4);
+
+  return(TEST_RESULT());
+}
@@ -0,0 +1,168 @@
+/*
+  test_override_replan.c - Planner work per motion override change
+  Part of Grbl
+
+  Fills the planner buffer with a zigzag of feeds and rapids and applies feed and rapid override
+  changes, both as Grbl 1.1h did and through the lazy refresh, counting the nominal speed computations
+  each costs. The 1.1h path recomputed every block in plan_update_velocity_profile_parameters() and
+  then replanned from the tail. It is reproduced here from the release. Calls are counted by the
+  compiler function instrumentation, as the planner calls within planner.c are not otherwise seen.
+  Both paths must arrive at the same plan.
+*/
+
+#include <stdlib.h>
+#include "test.h"
+#include "planner.h"
+#include "settings.h"
+#include "system.h"
+
+#define BLOCKS (BLOCK_BUFFER_SIZE-1) // A full buffer.
+
+system_t sys;
+settings_t settings;
+int32_t sys_position[N_AXIS];
+struct { float distance; } thc_cut;
+static int nominal_calls;   // plan_compute_profile_nominal_speed() calls.
+static int stepper_updates; // st_update_plan_block_parameters() calls.
+
+void st_update_plan_block_parameters() { stepper_updates++; }
+uint8_t get_direction_pin_mask(uint8_t axis_idx) { return(1<<axis_idx); }
+void protocol_execute_realtime() { }
+void protocol_exec_rt_system() { }
+#define _delay_ms(ms)
+#define _delay_us(us)
+
+#include "../src/nuts_bolts.c"
+#include "../src/planner.c"
+
+void __attribute__((no_instrument_function)) __cyg_profile_func_enter(void *fn, void *site)
+{
+  if (fn == (void *)plan_compute_profile_nominal_speed) { nominal_calls++; }
+}
+
+void __attribute__((no_instrument_function)) __cyg_profile_func_exit(void *fn, void *site) { }
+
+// Grbl 1.1h plan_update_velocity_profile_parameters(). The blocks are left current, so the reverse
+// pass replans them as 1.1h did, without recomputing.
+static void baseline_update_velocity_profile_parameters()
+{
+  uint8_t block_index = block_buffer_tail;
+  plan_block_t *block;
+  float nominal_speed;
+  float prev_nominal_speed = SOME_LARGE_VALUE; // Set high for first block nominal speed calculation.
+  while (block_index != block_buffer_head) {
+    block = &block_buffer[block_index];
+    nominal_speed = plan_compute_profile_nominal_speed(block);
+    plan_compute_profile_parameters(block, nominal_speed, prev_nominal_speed);
+    prev_nominal_speed = nominal_speed;
+    block_index = plan_next_block_index(block_index);
+  }
+  pl.previous_nominal_speed = prev_nominal_speed; // Update prev nominal speed for next incoming block.
+}
+
+// Plans a full buffer of 10mm zigzag moves at 100% overrides. Every third move is a rapid.
+static void fill()
+{
+  plan_line_data_t pl_data;
+  float target[N_AXIS] = { 0.0, 0.0, 0.0 };
+  uint8_t idx;
+  sys.f_override = DEFAULT_FEED_OVERRIDE;
+  sys.r_override = DEFAULT_RAPID_OVERRIDE;
+  plan_reset();
+  for (idx=0; idx < BLOCKS; idx++) {
+    memset(&pl_data, 0, sizeof(plan_line_data_t));
+    pl_data.feed_rate = 2000.0;
+    if (idx % 3 == 2) { pl_data.condition = PL_COND_FLAG_RAPID_MOTION; }
+    target[X_AXIS] += 10.0;
+    target[Y_AXIS] = (idx & 1) ? 0.0 : 4.0*(1+idx%3);
+    plan_buffer_line(target, &pl_data);
+  }
+  CHECK(plan_check_full_buffer());
+  nominal_calls = 0;
+  stepper_updates = 0;
+}
+
+typedef struct {
+  int event;     // Nominal speed computations upon the override change.
+  int deferred;  // Nominal speed computations in the replan of the next planned line.
+  float entry_speed_sqr[BLOCK_BUFFER_SIZE];
+  float max_entry_speed_sqr[BLOCK_BUFFER_SIZE];
+} replan_t;
+
+static void record(replan_t *result)
+{
+  uint8_t idx;
+  for (idx=0; idx < BLOCK_BUFFER_SIZE; idx++) {
+    result->entry_speed_sqr[idx] = block_buffer[idx].entry_speed_sqr;
+    result->max_entry_speed_sqr[idx] = block_buffer[idx].max_entry_speed_sqr;
+  }
+}
+
+// Applies an override change as protocol_exec_rt_system() does, the 1.1h way or the current one.
+static replan_t change(uint8_t f_override, uint8_t r_override, uint8_t baseline)
+{
+  replan_t result;
+  fill();
+  uint8_t is_reduction = (f_override < sys.f_override) || (r_override < sys.r_override);
+  sys.f_override = f_override;
+  sys.r_override = r_override;
+  if (baseline) {
+    baseline_update_velocity_profile_parameters();
+    plan_cycle_reinitialize();
+  } else {
+    plan_update_velocity_profile_parameters();
+    if (is_reduction) { plan_cycle_reinitialize(); }
+    else { st_update_plan_block_parameters(); }
+  }
+  result.event = nominal_calls;
+  CHECK(stepper_updates >= 1); // The executing block is always re-profiled.
+  // The replan run by the next line. Without one pending, it is a check of the plan only.
+  nominal_calls = 0;
+  planner_recalculate();
+  result.deferred = nominal_calls;
+  record(&result);
+  return(result);
+}
+
+int main()
+{
+  const struct { uint8_t f, r; const char *name; } cases[] = {
+    { 50, 100, "feed 100->50%" },
+    { 150, 100, "feed 100->150%" },
+    { 100, 25, "rapid 100->25%" },
+  };
+  uint8_t idx, block;
+
+  settings.steps_per_mm[X_AXIS] = settings.steps_per_mm[Y_AXIS] = settings.steps_per_mm[Z_AXIS] = 100.0;
+  settings.max_rate[X_AXIS] = settings.max_rate[Y_AXIS] = settings.max_rate[Z_AXIS] = 10000.0;
+  settings.acceleration[X_AXIS] = settings.acceleration[Y_AXIS] = settings.acceleration[Z_AXIS] = 500.0*60*60;
+  settings.junction_deviation = 0.01;
+
+  printf("%d blocks. Nominal speed computations per override change:\n", BLOCKS);
+  printf("%-16s  1.1h: event next-line   lazy: event next-line\n", "");
+  for (idx=0; idx < sizeof(cases)/sizeof(cases[0]); idx++) {
+    replan_t before = change(cases[idx].f, cases[idx].r, true);
+    replan_t after = change(cases[idx].f, cases[idx].r, false);
+    printf("%-16s  %11d %9d  %11d %9d\n", cases[idx].name, before.event, before.deferred, after.event, after.deferred);
+
+    // 1.1h computes every block at the event, and the replan computes none.
+    CHECK(before.event == BLOCKS);
+    CHECK(before.deferred == 0);
+    // Each block is computed once. An increase computes only the newest at the event, for the next
+    // incoming block, and the rest in the next replan, which is run for the next line regardless.
+    if ((cases[idx].f < 100) || (cases[idx].r < 100)) {
+      CHECK(after.event == BLOCKS);
+      CHECK(after.deferred == 0);
+    } else {
+      CHECK(after.event == 1);
+      CHECK(after.deferred == BLOCKS-1);
+    }
+    // Same plan either way.
+    for (block=0; block < BLOCK_BUFFER_SIZE; block++) {
+      CHECK(after.max_entry_speed_sqr[block] == before.max_entry_speed_sqr[block]);
+      CHECK(after.entry_speed_sqr[block] == before.entry_speed_sqr[block]);
+    }
+  }
+
+  return(TEST_RESULT());
+}
@@ -0,0 +1,210 @@
+/*
+  test_thc_lock.c - Corner simulation of the THC anti-dive lock
+  Part of Grbl
+
+  Drives a single axis-limited corner approach through the planner junction limit and the segment
+  lock decision, for a range of corner angles. The velocity gate alone (lock below the anti-dive speed)
+  leaves the THC free while the torch decelerates from nominal down to the anti-dive speed, which is
+  when the arc voltage rises and the torch dives. With the planned deceleration flagged, the lock must
+  engage at the start of the ramp, so the THC never runs on a slowing torch ahead of a sharp corner.
+
+  The dive is then simulated through a corner and out of it. The arc voltage rises as the torch slows,
+  and falls with the torch height. The THC request and the Z ramp run on it as in main.c, once a
+  millisecond and once a tick, with the lock decided per segment. The peak dive must fall with each
+  lock, from none to the velocity gate to the planned deceleration.
+*/
+
+#include "test.h"
+#include "planner.h"
+#include "stepper.h"
+#include "defaults.h"
+
+#define ACCELERATION (500.0*60*60) // mm/min^2
+#define JUNCTION_DEVIATION 0.01 // mm
+#define NOMINAL_SPEED 3000.0 // mm/min
+#define THRESHOLD 80 // percent, $46
+#define APPROACH 20.0 // mm
+
+#ifndef THC_TICK_US
+  #define THC_TICK_US 128 // Timer2 overflow at 16MHz. See grbl.h.
+#endif
+#define CUT_ACCELERATION (100.0*60*60) // mm/min^2. A plasma table, slower than the corner sweep above.
+#define Z_STEPS_PER_MM 250.0
+#define THC_Z_RATE 1500.0 // mm/min
+#define THC_Z_ACCEL 250.0 // mm/sec^2
+#define ARC_SETPOINT 400 // ADC counts
+#define ARC_SPEED_COUNTS 100.0 // Arc voltage rise from nominal speed to a standstill, in ADC counts.
+#define ARC_HEIGHT_COUNTS 20.0 // Arc voltage per mm of torch height, in ADC counts.
+
+enum { LOCK_NONE, LOCK_GATE, LOCK_LOOKAHEAD };
+
+typedef struct {
+  float lock_distance;  // Distance before the corner where the lock first engaged. Zero if never.
+  float unlocked_slow;  // Time spent below nominal speed with the THC free, in msec.
+} approach_t;
+
+// Steps an approach to the corner one acceleration tick at a time, as the segment generator does.
+static approach_t simulate(float junction_speed, uint8_t lookahead)
+{
+  approach_t result = { 0.0, 0.0 };
+  float lock_speed = NOMINAL_SPEED*(0.01*THRESHOLD);
+  float decel_distance = (NOMINAL_SPEED*NOMINAL_SPEED-junction_speed*junction_speed)/(2*ACCELERATION);
+  float dt = 1.0/(60*ACCELERATION_TICKS_PER_SECOND); // min
+  float distance = APPROACH;
+  float speed = NOMINAL_SPEED;
+  while (distance > 0.0) {
+    uint8_t is_decel = (distance <= decel_distance);
+    uint8_t lock;
+    if (lookahead) { lock = st_thc_lock_check(speed, junction_speed, lock_speed, is_decel); }
+    else { lock = (speed < lock_speed); }
+    if (lock && (result.lock_distance == 0.0)) { result.lock_distance = distance; }
+    if (!lock && (speed < NOMINAL_SPEED)) { result.unlocked_slow += dt*60000; }
+
+    if (is_decel) {
+      float next_speed = sqrt(max(junction_speed*junction_speed,
+                                  junction_speed*junction_speed+2*ACCELERATION*(distance-speed*dt)));
+      distance -= 0.5*(speed+next_speed)*dt;
+      speed = next_speed;
+    } else if (distance-speed*dt < decel_distance) {
+      distance = decel_distance; // Land on the start of the ramp.
+    } else {
+      distance -= speed*dt;
+    }
+  }
+  return(result);
+}
+
+// Arc voltage sample at the torch speed and height error, as read by thc_update().
+static uint16_t arc_voltage(float speed, float z)
+{
+  return(lround(ARC_SETPOINT + ARC_SPEED_COUNTS*(1.0-speed/NOMINAL_SPEED) + ARC_HEIGHT_COUNTS*z));
+}
+
+// Runs the THC through a corner and back up to nominal speed, one tick at a time, and returns the
+// peak dive in mm. Velocity and acceleration are fixed point steps per tick, as set by thc_init().
+static float dive(float junction_speed, uint8_t mode)
+{
+  float lock_speed = NOMINAL_SPEED*(0.01*THRESHOLD);
+  float decel_distance = (NOMINAL_SPEED*NOMINAL_SPEED-junction_speed*junction_speed)/(2*CUT_ACCELERATION);
+  float steps_per_tick = Z_STEPS_PER_MM*(THC_TICK_US/1000000.0)*65536.0;
+  uint16_t z_max_velocity = min((THC_Z_RATE/60.0)*steps_per_tick, 65535.0);
+  uint16_t z_acceleration = THC_Z_ACCEL*(THC_TICK_US/1000000.0)*steps_per_tick;
+  float dt = THC_TICK_US/60000000.0; // min
+  float segment_time = 0.0;
+  float settle_time = 0.2/60; // min at nominal speed past the corner.
+  float distance = APPROACH; // To the corner. Negative past it.
+  float speed = NOMINAL_SPEED;
+  uint16_t millis_remainder = 0;
+  uint8_t lock = false;
+  int8_t z_request = 0, z_dir = 0;
+  uint16_t z_velocity = 0, z_phase = 0;
+  int32_t z = 0, z_min = 0;
+
+  while (settle_time > 0.0) {
+    // Segment lock, decided at the start of each segment as by st_prep_buffer().
+    segment_time -= dt;
+    if (segment_time <= 0.0) {
+      segment_time += 1.0/(60*ACCELERATION_TICKS_PER_SECOND);
+      uint8_t is_decel = (distance > 0.0) && (distance <= decel_distance);
+      if (mode == LOCK_LOOKAHEAD) { lock = st_thc_lock_check(speed, junction_speed, lock_speed, is_decel); }
+      else if (mode == LOCK_GATE) { lock = (speed < lock_speed); }
+      else { lock = false; }
+    }
+
+    // Z ramp and step, as by the THC tick ISR.
+    if (z_request && ((z_request == z_dir) || (z_velocity == 0))) {
+      z_dir = z_request;
+      if (z_velocity < (z_max_velocity - z_acceleration)) { z_velocity += z_acceleration; }
+      else { z_velocity = z_max_velocity; }
+    } else if (z_velocity > z_acceleration) { z_velocity -= z_acceleration; }
+    else { z_velocity = 0; }
+    uint16_t last_phase = z_phase;
+    z_phase += z_velocity;
+    if (z_phase < last_phase) { z += z_dir; }
+    if (z < z_min) { z_min = z; }
+
+    // THC request, once a millisecond as by thc_update().
+    millis_remainder += THC_TICK_US;
+    if (millis_remainder >= 1000) {
+      millis_remainder -= 1000;
+      uint16_t analog = arc_voltage(speed, z/Z_STEPS_PER_MM);
+      uint8_t in_band = (analog > (ARC_SETPOINT - DEFAULT_THC_DEADBAND)) && (analog < (ARC_SETPOINT + DEFAULT_THC_DEADBAND));
+      if (lock || in_band) { z_request = 0; }
+      else if (analog > ARC_SETPOINT) { z_request = -1; }
+      else { z_request = 1; }
+    }
+
+    // Torch motion. Decelerates into the corner and accelerates back out of it.
+    distance -= speed*dt;
+    if (distance > 0.0) {
+      if (distance < decel_distance) { speed = sqrt(junction_speed*junction_speed+2*CUT_ACCELERATION*distance); }
+    } else {
+      speed = min(NOMINAL_SPEED, sqrt(junction_speed*junction_speed-2*CUT_ACCELERATION*distance));
+      if (speed == NOMINAL_SPEED) { settle_time -= dt; }
+    }
+  }
+  return(-z_min/Z_STEPS_PER_MM);
+}
+
+int main()
+{
+  float lock_speed = NOMINAL_SPEED*(0.01*THRESHOLD);
+  const uint8_t angles[] = { 2, 5, 7, 8, 10, 15, 30, 45, 60, 90, 120, 150 };
+  uint8_t idx, angle;
+  printf("angle  junction  gate only: lock_mm free_ms  lookahead: lock_mm free_ms\n");
+  for (idx = 0; idx < sizeof(angles); idx++) {
+    angle = angles[idx];
+    // Junction cosine as computed by plan_buffer_line(), the negated dot product of the unit vectors.
+    float junction_cos_theta = -cos(angle*M_PI/180.0);
+    float junction_speed_sqr = plan_compute_junction_speed_sqr(junction_cos_theta, ACCELERATION, JUNCTION_DEVIATION);
+    float junction_speed = sqrt(min(junction_speed_sqr, NOMINAL_SPEED*NOMINAL_SPEED));
+    approach_t gate = simulate(junction_speed, false);
+    approach_t lookahead = simulate(junction_speed, true);
+    printf("%5d  %8.0f  %18.3f %7.1f  %18.3f %7.1f\n", angle, junction_speed,
+           gate.lock_distance, gate.unlocked_slow, lookahead.lock_distance, lookahead.unlocked_slow);
+
+    if (junction_speed < lock_speed) {
+      // Sharp corner. The lookahead lock engages at the ramp start, ahead of the velocity gate, and
+      // the THC is never free on a slowing torch.
+      CHECK(lookahead.lock_distance > gate.lock_distance);
+      CHECK(lookahead.unlocked_slow == 0.0);
+      CHECK(gate.unlocked_slow > 0.0);
+    } else {
+      // Shallow corner. The torch never drops below the anti-dive speed, so neither locks.
+      CHECK(lookahead.lock_distance == 0.0);
+      CHECK(gate.lock_distance == 0.0);
+    }
+  }
+
+  // Peak dive through a corner, with each lock.
+  printf("angle  junction  dive mm: none    gate  lookahead\n");
+  for (idx = 0; idx < sizeof(angles); idx++) {
+    angle = angles[idx];
+    float junction_speed_sqr = plan_compute_junction_speed_sqr(-cos(angle*M_PI/180.0), CUT_ACCELERATION, JUNCTION_DEVIATION);
+    float junction_speed = sqrt(min(junction_speed_sqr, NOMINAL_SPEED*NOMINAL_SPEED));
+    float none = dive(junction_speed, LOCK_NONE);
+    float gate = dive(junction_speed, LOCK_GATE);
+    float lookahead = dive(junction_speed, LOCK_LOOKAHEAD);
+    printf("%5d  %8.0f  %12.3f %7.3f %10.3f\n", angle, junction_speed, none, gate, lookahead);
+
+    CHECK(gate <= none);
+    CHECK(lookahead <= gate);
+    if (junction_speed < lock_speed) {
+      // Sharp corner. Each lock holds Z through more of the slowdown.
+      CHECK(gate < none);
+      CHECK(lookahead < gate);
+    } else {
+      CHECK(lookahead == gate); // Never locked.
+    }
+  }
+
+  // Junction limits fall monotonically with the corner angle.
+  float last = SOME_LARGE_VALUE;
+  for (angle = 10; angle < 180; angle += 10) {
+    float speed_sqr = plan_compute_junction_speed_sqr(-cos(angle*M_PI/180.0), ACCELERATION, JUNCTION_DEVIATION);
+    CHECK(speed_sqr < last);
+    last = speed_sqr;
+  }
+
+  return(TEST_RESULT());
+}